@@ -11,13 +11,37 @@ void pcf8574_configure(pcf8574_config_s *config, uint16_t i2c_addr, I2C_Fcn writ
     config->i2c_read_fun = read_fun;
     config->rd_buffer = 0x00;
     config->wr_buffer = 0x00;
+    config->dual_enable = false;
+}
+
+void pcf8574_configure_dual(pcf8574_config_s *config, bool dual_enable){
+    config->dual_enable = dual_enable;
 }
 
 bool pcf8574_write(pcf8574_config_s *config, uint8_t data){
+    uint8_t previous = config->wr_buffer;
     // Save data to buffer
     config->wr_buffer = data;
     // Write the data via the configured I2C function
-    return config->i2c_write_fun(config->i2c_addr, &(config->wr_buffer), 1);
+    if (config->i2c_write_fun(config->i2c_addr, &(config->wr_buffer), 1))
+        return true;
+    // Outputs are unchanged without acknowledge, keep the buffer consistent for pcf8574_read()
+    config->wr_buffer = previous;
+    return false;
+}
+
+bool pcf8574_write_burst(pcf8574_config_s *config, uint8_t *data, uint32_t len){
+    if (len == 0)
+        return true;
+    // Buffer holds the last output state
+    // Every byte is latched to the outputs after its acknowledge
+    if (config->i2c_write_fun(config->i2c_addr, data, len)){
+        config->wr_buffer = data[len - 1];
+        return true;
+    }
+    // Output state is unknown after a partial transfer, force pcf8574_read() to assert the pins again
+    config->wr_buffer = 0x00;
+    return false;
 }
 
 bool pcf8574_read(pcf8574_config_s *config, uint8_t mask){
@@ -36,26 +60,117 @@ bool pcf8574_read(pcf8574_config_s *config, uint8_t mask){
     return config->i2c_read_fun(config->i2c_addr, &(config->rd_buffer), 1);
 }
 
+bool pcf8574_input_init(pcf8574_input_s *input, pcf8574_config_s *device, uint8_t mask, uint32_t debounce_time, PCF8574_Event_Fcn event_fun, void *context){
+    input->device = device;
+    input->mask = mask;
+    input->irq_pending = false;
+    input->settling = 0x00;
+    input->debounce_time = debounce_time;
+    input->event_fun = event_fun;
+    input->context = context;
+    for (uint8_t pin = 0; pin < 8; pin++)
+        input->changed_at[pin] = 0;
+    
+    // Input pins stay high from now on, following reads need no write
+    // Reading also releases the INT line
+    if (!pcf8574_read(device, mask))
+        return false;
+    
+    // Initial levels are taken as stable without events
+    input->raw = device->rd_buffer & mask;
+    input->stable = input->raw;
+    return true;
+}
+
+void pcf8574_input_irq(pcf8574_input_s *input){
+    input->irq_pending = true;
+}
+
+bool pcf8574_input_poll(pcf8574_input_s *input, uint32_t now){
+    uint8_t changed;
+    
+    // Read only after the INT line signalled a change
+    if (input->irq_pending){
+        // Clear before reading, a change during the read fires INT again
+        input->irq_pending = false;
+        if (!pcf8574_read(input->device, input->mask)){
+            // Retry on next poll
+            input->irq_pending = true;
+            return false;
+        }
+        
+        // Restart debounce time of every pin that toggled since the last read
+        changed = (input->device->rd_buffer & input->mask) ^ input->raw;
+        input->raw ^= changed;
+        input->settling |= changed;
+        for (uint8_t pin = 0; pin < 8; pin++){
+            if (changed & (1 << pin))
+                input->changed_at[pin] = now;
+        }
+    }
+    
+    // Accept levels held for the debounce time
+    // No read needed, any further change would have fired INT
+    for (uint8_t pin = 0; input->settling && pin < 8; pin++){
+        uint8_t bit = 1 << pin;
+        if (!(input->settling & bit) || (uint32_t) (now - input->changed_at[pin]) < input->debounce_time)
+            continue;
+        
+        input->settling &= ~bit;
+        // Bounces ending on the previous level produce no event
+        if ((input->raw ^ input->stable) & bit){
+            input->stable ^= bit;
+            if (input->event_fun != NULL)
+                input->event_fun(input->context, pin, (input->stable & bit) != 0);
+        }
+    }
+    return true;
+}
+
+// Map LCD command lines to PCF8574 GPIOs
+static uint8_t pcf8574_lcd_map(const pcf8574_config_s *config, lcd_cmd_s lcd_cmd){
+    // Second enable line takes the place of the back light on dual-controller panels
+    uint8_t e2_ledk = config->dual_enable ? lcd_cmd.e2 : lcd_cmd.ledk;
+    
+    return  (lcd_cmd.rs << RS_PIN) | 
+            (lcd_cmd.rw << RW_PIN) |
+            (lcd_cmd.e << E_PIN) |
+            (e2_ledk << E2_PIN) |
+            // Bitmask the i-th bit and shift it right by i, then map
+            ((lcd_cmd.data & (1 << 4)) >> 4 << DB4_PIN) |
+            ((lcd_cmd.data & (1 << 5)) >> 5 << DB5_PIN) |
+            ((lcd_cmd.data & (1 << 6)) >> 6 << DB6_PIN) |
+            ((lcd_cmd.data & (1 << 7)) >> 7 << DB7_PIN);
+}
+
 bool pcf8574_lcd_if_write(void *interface_config, lcd_cmd_s lcd_cmd){
     // Cast generic interface configuration to PCF configuration
     pcf8574_config_s *config = (pcf8574_config_s *) interface_config;
-    
-    // Map LCD command lines to PC8574 GPIOs
-    uint8_t output =    (lcd_cmd.rs << RS_PIN) | 
-                        (lcd_cmd.rw << RW_PIN) |
-                        (lcd_cmd.e << E_PIN) |
-                        (lcd_cmd.ledk << LEDK_PIN) |
-                        // Bitmask the i-th bit and shift it right by i, then map
-                        ((lcd_cmd.data & (1 << 4)) >> 4 << DB4_PIN) |
-                        ((lcd_cmd.data & (1 << 5)) >> 5 << DB5_PIN) |
-                        ((lcd_cmd.data & (1 << 6)) >> 6 << DB6_PIN) |
-                        ((lcd_cmd.data & (1 << 7)) >> 7 << DB7_PIN);
    
     // Write the data from the buffer to the device
-    return pcf8574_write(config, output);
+    return pcf8574_write(config, pcf8574_lcd_map(config, lcd_cmd));
+}
+
+bool pcf8574_lcd_if_write_burst(void *interface_config, const lcd_cmd_s *lcd_cmds, uint16_t count){
+    // Cast generic interface configuration to PCF configuration
+    pcf8574_config_s *config = (pcf8574_config_s *) interface_config;
+    uint8_t output[PCF8574_BURST_BYTES];
+    uint16_t n;
+    
+    // Split long sequences into transfers of at most PCF8574_BURST_BYTES
+    while (count > 0){
+        n = (count < PCF8574_BURST_BYTES) ? count : PCF8574_BURST_BYTES;
+        for (uint16_t i = 0; i < n; i++)
+            output[i] = pcf8574_lcd_map(config, lcd_cmds[i]);
+        if (!pcf8574_write_burst(config, output, n))
+            return false;
+        lcd_cmds += n;
+        count -= n;
+    }
+    return true;
 }
 
-uint8_t pcf8574_lcd_if_read(void *interface_config){
+bool pcf8574_lcd_if_read(void *interface_config, uint8_t *data){
     // Cast generic interface configuration to PCF configuration
     pcf8574_config_s *config = (pcf8574_config_s *) interface_config;
     
@@ -64,16 +179,29 @@ uint8_t pcf8574_lcd_if_read(void *interface_config){
                     (1 << DB6_PIN) | (1 << DB7_PIN);
     
     // Read data pins to buffer inside configuration
-    pcf8574_read(config, mask);
+    if (!pcf8574_read(config, mask))
+        return false;
             
     // Translate value from buffer to data value
     // Bitmask the data pins and shift them to their bit position
-    uint8_t data =  ((config->rd_buffer) & (1 << DB4_PIN)) >> DB4_PIN << 4 |
-                    ((config->rd_buffer) & (1 << DB5_PIN)) >> DB5_PIN << 5 |
-                    ((config->rd_buffer) & (1 << DB6_PIN)) >> DB6_PIN << 6 |
-                    ((config->rd_buffer) & (1 << DB7_PIN)) >> DB7_PIN << 7;
+    *data = ((config->rd_buffer) & (1 << DB4_PIN)) >> DB4_PIN << 4 |
+            ((config->rd_buffer) & (1 << DB5_PIN)) >> DB5_PIN << 5 |
+            ((config->rd_buffer) & (1 << DB6_PIN)) >> DB6_PIN << 6 |
+            ((config->rd_buffer) & (1 << DB7_PIN)) >> DB7_PIN << 7;
     
     // Reset buffer
     config->rd_buffer = 0x00;
-    return data;
-}
\ No newline at end of file
+    return true;
+}
+
+uint16_t pcf8574_lcd_if_latency_us(uint32_t bus_hz){
+    // Outputs are latched at the acknowledge of the data byte, 19 clock periods after start
+    // Rounded down, software overhead of the I2C function only adds to it
+    return (uint16_t) (19UL * 1000000UL / bus_hz);
+}
+
+uint16_t pcf8574_lcd_if_burst_edge_us(uint32_t bus_hz){
+    // Every further byte of a transfer is latched 9 clock periods after the previous one
+    // Rounded down, the LCD side adds hold commands if this is shorter than the execution time
+    return (uint16_t) (9UL * 1000000UL / bus_hz);
+}
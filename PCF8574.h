@@ -25,9 +25,15 @@ extern "C" {
 #define DB5_PIN     5
 #define DB6_PIN     6
 #define DB7_PIN     7   
+// Second enable line of dual-controller panels replaces the back light pin (back light must be hardwired)
+#define E2_PIN      LEDK_PIN
+// Output bytes per I2C transfer of a burst write
+#define PCF8574_BURST_BYTES     (1 + 4 * LCD_BURST_BYTES)
     
 // I2C Bus Function Signature
 typedef bool (*I2C_Fcn)(uint16_t, uint8_t*, uint32_t);
+// Input event callback with pin number and new level
+typedef void (*PCF8574_Event_Fcn)(void *context, uint8_t pin, bool level);
     
 // Configuration structure for the PCF8574 GPIO Expander
 typedef struct{
@@ -36,23 +42,56 @@ typedef struct{
     I2C_Fcn i2c_read_fun;      // I2C Bus Read Function to be used
     uint8_t rd_buffer;         // Buffer to store received data
     uint8_t wr_buffer;         // Buffer to store data to be sent
+    bool dual_enable;          // E2_PIN drives the second enable line instead of the back light
 
 }pcf8574_config_s;
 
+// Event-driven input state, the bus is only read after the INT line fired
+typedef struct{
+    pcf8574_config_s *device;       // Expander the inputs belong to
+    uint8_t mask;                   // Pins used as inputs
+    volatile bool irq_pending;      // Set by the INT handler, cleared by the next read
+    uint8_t raw;                    // Input levels of the last read
+    uint8_t stable;                 // Debounced input levels
+    uint8_t settling;               // Pins that changed and are not debounced yet
+    uint32_t changed_at[8];         // Time stamp of the last change of each pin
+    uint32_t debounce_time;         // Time a level has to be held to be accepted
+    PCF8574_Event_Fcn event_fun;    // Callback for debounced edges
+    void *context;                  // Passed to the callback
+}pcf8574_input_s;
+
 // Edit the configuration data
 void pcf8574_configure(pcf8574_config_s *config, uint16_t i2c_addr, I2C_Fcn write_fun, I2C_Fcn read_fun);
+// Use E2_PIN as second enable line for dual-controller LCDs (e.g. 40x4)
+void pcf8574_configure_dual(pcf8574_config_s *config, bool dual_enable);
 
 /* Standalone functions */
 // Write a byte to the device output
 bool pcf8574_write(pcf8574_config_s *config, uint8_t data);
+// Write a sequence of bytes in one transfer, the outputs follow every byte
+bool pcf8574_write_burst(pcf8574_config_s *config, uint8_t *data, uint32_t len);
 // Read a byte from the device input
 bool pcf8574_read(pcf8574_config_s *config, uint8_t mask);
 
+/* Event-driven input */
+// Assert input pins and read initial levels, time stamps and debounce time use the unit of the caller's clock
+bool pcf8574_input_init(pcf8574_input_s *input, pcf8574_config_s *device, uint8_t mask, uint32_t debounce_time, PCF8574_Event_Fcn event_fun, void *context);
+// Signal a falling edge of the INT line, safe to call from the interrupt handler (no bus access)
+void pcf8574_input_irq(pcf8574_input_s *input);
+// Read the inputs if INT fired and deliver debounced edges, call periodically from the main loop
+bool pcf8574_input_poll(pcf8574_input_s *input, uint32_t now);
+
 /* Interface functions for usage as LCD io */
 // Convert a 12-bit parallel interface command for an LCD for a hooked up expander
 bool pcf8574_lcd_if_write(void *interface_config, lcd_cmd_s lcd_cmd);
-// Read the 8-bit data lines
-uint8_t pcf8574_lcd_if_read(void *interface_config);
+// Convert a sequence of commands and write them in as few transfers as possible
+bool pcf8574_lcd_if_write_burst(void *interface_config, const lcd_cmd_s *lcd_cmds, uint16_t count);
+// Read the 8-bit data lines, false if the transfer failed
+bool pcf8574_lcd_if_read(void *interface_config, uint8_t *data);
+// Time until the outputs change after a write call starts (start, address and data byte with acknowledge)
+uint16_t pcf8574_lcd_if_latency_us(uint32_t bus_hz);
+// Time between two outputs within a burst (data byte with acknowledge)
+uint16_t pcf8574_lcd_if_burst_edge_us(uint32_t bus_hz);
 
 #ifdef	__cplusplus
 }
@@ -0,0 +1,44 @@
+// Host benchmark of UTF-8 decoding plus character ROM lookup
+// Build and run from this directory:
+//   gcc -std=c99 -O1 -I.. -o charset_bench charset_bench.c ../lcd_charset.c && ./charset_bench
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "lcd_charset.h"
+
+#define BENCH_ITERATIONS    2000000
+
+// Mixed text: ASCII, Latin-1, Greek, arrows and halfwidth katakana
+static const char *bench_text = "Temp 25\xC2\xB0" "C \xCE\xB1=3\xC2\xB5s \xE2\x86\x92 \xC3\xA4\xC3\xB6\xC3\xBC \xEF\xBD\xB1\xEF\xBD\xB2 plain ascii text";
+
+int main(void){
+    lcd_charset_s charset;
+    volatile uint32_t sink = 0;
+    uint32_t chars = 0;
+    size_t len = strlen(bench_text);
+    
+    for (int rom = LCD_ROM_A00; rom <= LCD_ROM_A02; rom++){
+        lcd_charset_init(&charset, (lcd_rom_e) rom, NULL, 0, 0, 0);
+        chars = 0;
+        
+        clock_t start = clock();
+        for (long i = 0; i < BENCH_ITERATIONS; i++){
+            for (size_t j = 0; j < len; j++){
+                uint32_t code_point;
+                uint8_t code;
+                
+                if (!lcd_utf8_decode(&charset, (uint8_t) bench_text[j], &code_point))
+                    continue;
+                if (lcd_charset_rom(charset.rom, code_point, &code))
+                    sink += code;
+                chars++;
+            }
+        }
+        double seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+        
+        printf("ROM %s: %.2f ns per character (%lu characters per pass)\n", rom == LCD_ROM_A00 ? "A00" : "A02",
+               seconds * 1e9 / chars, (unsigned long) (chars / BENCH_ITERATIONS));
+    }
+    return 0;
+}
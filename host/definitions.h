@@ -0,0 +1,10 @@
+// Host stand-in for the MCU framework header included by the drivers
+// Host builds pass -DDELAY_H so the target delay routines of delay.h are skipped, hd44780_sim.c defines delay_usec()
+#ifndef DEFINITIONS_H
+#define	DEFINITIONS_H
+
+#include <stdint.h>
+
+void delay_usec(uint32_t n);
+
+#endif	/* DEFINITIONS_H */
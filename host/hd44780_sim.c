@@ -0,0 +1,221 @@
+#include <stdint.h>
+#include <string.h>
+#include "hd44780_sim.h"
+#include "PCF8574.h"
+
+sim_s sim;
+
+// Host replacement of the delay routine, the time is only counted
+void delay_usec(uint32_t n){
+    sim.delay_us += n;
+}
+
+void sim_reset(bool dual){
+    memset(&sim, 0, sizeof(sim));
+    sim.dual = dual;
+    
+    // Controllers start in 8-bit mode after power-on
+    for (uint8_t i = 0; i < SIM_CTRL_COUNT; i++){
+        memset(sim.ctrl[i].ddram, ' ', sizeof(sim.ctrl[i].ddram));
+        sim.ctrl[i].mode_8bit = true;
+        sim.ctrl[i].increment = true;
+        sim.ctrl[i].lines = 1;
+    }
+}
+
+// Next address of the counter, DDRAM of two line mode continues from 0x27 at 0x40 and from 0x67 at 0x00
+static uint8_t sim_next_addr(const sim_ctrl_s *c, int addr){
+    if (c->cgram_selected)
+        return addr & 0x3f;
+    if (c->lines == 2){
+        if (addr == 0x28)
+            return 0x40;
+        if (addr == 0x3f)
+            return 0x27;
+        if (addr == 0x68 || addr < 0)
+            return 0x00;
+        return addr & 0x7f;
+    }
+    return (addr + 80) % 80;
+}
+
+static void sim_instruction(sim_ctrl_s *c, uint8_t cmd){
+    if (cmd & 0x80){
+        c->ac = cmd & 0x7f;
+        c->cgram_selected = false;
+    }
+    else if (cmd & 0x40){
+        c->ac = cmd & 0x3f;
+        c->cgram_selected = true;
+    }
+    else if (cmd & 0x20){
+        c->mode_8bit = (cmd & 0x10) != 0;
+        c->lines = (cmd & 0x08) ? 2 : 1;
+        c->function_set = cmd;
+        c->half = false;
+    }
+    else if (cmd & 0x10){
+        // Shifting the display right moves the content away from address 0
+        int dir = (cmd & 0x04) ? 1 : -1;
+        if (cmd & 0x08)
+            c->shift -= dir;
+        else
+            c->ac = sim_next_addr(c, c->ac + dir);
+    }
+    else if (cmd & 0x08)
+        c->display_control = cmd & 0x07;
+    else if (cmd & 0x04)
+        c->increment = (cmd & 0x02) != 0;
+    else if (cmd & 0x02){
+        c->ac = 0;
+        c->cgram_selected = false;
+        c->shift = 0;
+    }
+    else if (cmd & 0x01){
+        memset(c->ddram, ' ', sizeof(c->ddram));
+        c->ac = 0;
+        c->cgram_selected = false;
+        c->shift = 0;
+        c->increment = true;
+    }
+}
+
+static void sim_data(sim_ctrl_s *c, uint8_t data){
+    if (c->cgram_selected)
+        c->cgram[c->ac & 0x3f] = data;
+    else
+        c->ddram[c->ac & 0x7f] = data;
+    c->ac = sim_next_addr(c, c->ac + (c->increment ? 1 : -1));
+}
+
+// Falling enable edge of a write
+static void sim_latch(sim_ctrl_s *c, uint8_t pins){
+    uint8_t nibble = pins >> DB4_PIN;
+    uint8_t value;
+    
+    if (c->mode_8bit)
+        value = nibble << 4;
+    else if (!c->half){
+        c->upper = nibble;
+        c->half = true;
+        return;
+    }
+    else{
+        c->half = false;
+        value = (c->upper << 4) | nibble;
+    }
+    
+    if (pins & (1 << RS_PIN))
+        sim_data(c, value);
+    else
+        sim_instruction(c, value);
+}
+
+static void sim_output(uint8_t pins){
+    uint8_t old = sim.pins;
+    bool rs = (pins & (1 << RS_PIN)) != 0;
+    bool rw = (pins & (1 << RW_PIN)) != 0;
+    
+    sim.pins = pins;
+    for (uint8_t i = 0; i < (sim.dual ? 2 : 1); i++){
+        uint8_t e = (i == 0) ? (1 << E_PIN) : (1 << E2_PIN);
+        sim_ctrl_s *c = &sim.ctrl[i];
+        
+        // Rising edge of a read cycle fetches the byte, both nibbles are taken from it
+        if (rw && !(old & e) && (pins & e) && (c->mode_8bit || !c->half))
+            c->read_latch = rs ? (c->cgram_selected ? c->cgram[c->ac & 0x3f] : c->ddram[c->ac & 0x7f]) : (c->ac & 0x7f);
+        
+        if (!((old & e) && !(pins & e)))
+            continue;
+        if (!rw)
+            sim_latch(c, pins);
+        else{
+            // Reading data advances the address counter after the complete byte
+            if (!c->mode_8bit)
+                c->half = !c->half;
+            if (rs && !c->half)
+                c->ac = sim_next_addr(c, c->ac + 1);
+        }
+    }
+}
+
+// Transaction falls into the failure window
+static bool sim_failing(void){
+    return sim.fail_len > 0 && sim.transactions >= sim.fail_at && sim.transactions < sim.fail_at + sim.fail_len;
+}
+
+bool sim_i2c_write(uint16_t addr, uint8_t *data, uint32_t len){
+    bool fail = sim_failing();
+    (void) addr;
+    
+    sim.transactions++;
+    sim.bytes += len;
+    if (fail){
+        if (sim.fail_mode == SIM_FAIL_LATCHED)
+            for (uint32_t i = 0; i < len; i++)
+                sim_output(data[i]);
+        else if (sim.fail_mode == SIM_FAIL_FIRST_BYTE && len > 1)
+            sim_output(data[0]);
+        return false;
+    }
+    for (uint32_t i = 0; i < len; i++)
+        sim_output(data[i]);
+    return true;
+}
+
+bool sim_i2c_read(uint16_t addr, uint8_t *data, uint32_t len){
+    uint8_t value = sim.pins;
+    bool fail = sim_failing();
+    (void) addr;
+    
+    sim.transactions++;
+    sim.bytes += len;
+    if (fail){
+        data[0] = 0xFF;
+        return false;
+    }
+    
+    // Controllers with enable and R/W high drive the data lines
+    for (uint8_t i = 0; i < (sim.dual ? 2 : 1); i++){
+        uint8_t e = (i == 0) ? (1 << E_PIN) : (1 << E2_PIN);
+        const sim_ctrl_s *c = &sim.ctrl[i];
+        
+        if ((sim.pins & e) && (sim.pins & (1 << RW_PIN))){
+            uint8_t nibble = (c->mode_8bit || !c->half) ? (c->read_latch >> 4) : (c->read_latch & 0x0f);
+            value = (value & 0x0f) | (nibble << 4);
+        }
+    }
+    for (uint32_t i = 0; i < len; i++)
+        data[i] = value;
+    return true;
+}
+
+uint32_t sim_wire_us(uint32_t transactions, uint32_t bytes, uint32_t bus_hz){
+    return (uint32_t) (((uint64_t) transactions * 11 + (uint64_t) bytes * 9) * 1000000UL / bus_hz);
+}
+
+void sim_row(uint8_t ctrl, uint8_t line_addr, uint8_t cols, char *out){
+    const sim_ctrl_s *c = &sim.ctrl[ctrl];
+    uint8_t base = (line_addr >= 0x40) ? 0x40 : 0x00;
+    
+    for (uint8_t i = 0; i < cols; i++){
+        int offset = ((line_addr - base) + i + c->shift) % 40;
+        uint8_t code = c->ddram[base + ((offset < 0) ? offset + 40 : offset)];
+        out[i] = (code >= 0x20 && code < 0x7f) ? (char) code : '#';
+    }
+    out[cols] = '\0';
+}
+
+bool sim_same_display(const sim_s *a, const sim_s *b){
+    for (uint8_t i = 0; i < SIM_CTRL_COUNT; i++){
+        const sim_ctrl_s *x = &a->ctrl[i];
+        const sim_ctrl_s *y = &b->ctrl[i];
+        
+        if (memcmp(x->ddram, y->ddram, sizeof(x->ddram)) || memcmp(x->cgram, y->cgram, sizeof(x->cgram)) ||
+            x->ac != y->ac || x->cgram_selected != y->cgram_selected || x->shift != y->shift ||
+            x->increment != y->increment || x->display_control != y->display_control ||
+            x->function_set != y->function_set || x->mode_8bit != y->mode_8bit || x->half != y->half)
+            return false;
+    }
+    return true;
+}
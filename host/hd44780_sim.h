@@ -0,0 +1,62 @@
+// Host model of one or two HD44780 controllers behind a PCF8574, used by the host benchmarks
+// Instructions and data are latched on falling enable edges, reads return the address counter or RAM
+// Transactions can be failed on purpose to measure the error handling of the driver
+#ifndef HD44780_SIM_H
+#define	HD44780_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SIM_CTRL_COUNT      2
+
+// Behaviour of a failed transaction
+typedef enum {
+    SIM_FAIL_NACK,          // Nothing reaches the outputs
+    SIM_FAIL_LATCHED,       // Every byte reaches the outputs, the transfer is reported as failed anyway
+    SIM_FAIL_FIRST_BYTE     // Transfer breaks after the first byte of a burst
+} sim_fail_e;
+
+// State of one controller
+typedef struct{
+    uint8_t ddram[128];
+    uint8_t cgram[64];
+    uint8_t ac;                 // Address counter
+    bool cgram_selected;        // Address counter points to CGRAM
+    int8_t shift;               // Display shift in cells
+    bool increment;
+    uint8_t lines;
+    uint8_t display_control;    // Display, cursor and blink flags
+    uint8_t function_set;
+    bool mode_8bit;
+    bool half;                  // Upper nibble transferred, lower nibble expected (4-bit mode)
+    uint8_t upper;
+    uint8_t read_latch;         // Byte being read
+}sim_ctrl_s;
+
+typedef struct{
+    sim_ctrl_s ctrl[SIM_CTRL_COUNT];
+    bool dual;                  // Back light pin drives the enable line of the second controller
+    uint8_t pins;               // Expander outputs
+    uint32_t transactions;      // I2C transactions, reads and writes
+    uint32_t bytes;             // Data bytes of all transactions
+    uint32_t delay_us;          // Sum of all delay_usec() calls
+    uint32_t fail_at;           // First failing transaction
+    uint32_t fail_len;          // Number of failing transactions, 0 for none
+    sim_fail_e fail_mode;
+}sim_s;
+
+extern sim_s sim;
+
+// Power-on state, counters cleared, no failures
+void sim_reset(bool dual);
+// I2C_Fcn compatible callbacks
+bool sim_i2c_write(uint16_t addr, uint8_t *data, uint32_t len);
+bool sim_i2c_read(uint16_t addr, uint8_t *data, uint32_t len);
+// Wire time of transactions, start, address byte and stop take 11 clock periods, every data byte 9
+uint32_t sim_wire_us(uint32_t transactions, uint32_t bytes, uint32_t bus_hz);
+// Cells of a row starting at a line address as shown with the current display shift, '#' for codes outside ASCII
+void sim_row(uint8_t ctrl, uint8_t line_addr, uint8_t cols, char *out);
+// Compare the controller state of two snapshots, counters are ignored
+bool sim_same_display(const sim_s *a, const sim_s *b);
+
+#endif	/* HD44780_SIM_H */
@@ -0,0 +1,98 @@
+// Host benchmark of the keypad scanner against a fake I2C bus, counts transactions per second
+// Build and run from this directory:
+//   gcc -std=c99 -O1 -I. -I.. -o keypad_bench keypad_bench.c ../pcf8574_keypad.c ../PCF8574.c && ./keypad_bench
+
+#include <stdio.h>
+#include "pcf8574_keypad.h"
+
+#define BENCH_SCAN_RATE     100     // Scans per second
+#define BENCH_SCANS         100     // Scans per scenario
+
+// Fake expander with a 4x4 matrix, pins written high are weak pull-ups
+static uint8_t fake_output = 0xFF;
+static uint16_t fake_pressed;
+static uint32_t fake_transactions;
+static uint32_t bench_events;
+
+static bool fake_write(uint16_t addr, uint8_t *data, uint32_t len){
+    (void) addr;
+    fake_output = data[len - 1];
+    fake_transactions++;
+    return true;
+}
+
+static bool fake_read(uint16_t addr, uint8_t *data, uint32_t len){
+    uint8_t levels = fake_output;
+    bool changed = true;
+    (void) addr;
+    (void) len;
+    
+    // A pressed key connects its row and column, a low level spreads through every connected key
+    // Three keys on the corners of a rectangle therefore pull the fourth corner low as well (ghosting)
+    while (changed){
+        changed = false;
+        for (uint8_t row = 0; row < KEYPAD_ROWS; row++){
+            for (uint8_t col = 0; col < KEYPAD_COLS; col++){
+                uint8_t pins = (1 << (4 + row)) | (1 << col);
+                
+                if (!(fake_pressed & KEYPAD_KEY(row, col)) || (levels & pins) == 0 || (levels & pins) == pins)
+                    continue;
+                levels &= ~pins;
+                changed = true;
+            }
+        }
+    }
+    *data = levels;
+    fake_transactions++;
+    return true;
+}
+
+static void bench_key(void *context, uint8_t key, bool pressed){
+    (void) context;
+    (void) key;
+    if (pressed)
+        bench_events++;
+}
+
+// Hold the keys for a number of scans, the INT line fires while keys are pressed
+static void bench_run(const char *name, pcf8574_keypad_s *keypad, uint16_t keys){
+    fake_pressed = keys;
+    fake_transactions = 0;
+    bench_events = 0;
+    for (int i = 0; i < BENCH_SCANS; i++){
+        if (keys != 0)
+            pcf8574_keypad_irq(keypad);
+        pcf8574_keypad_scan(keypad);
+    }
+    printf("%-32s %5lu transactions/s, %lu keys reported\n", name,
+           (unsigned long) (fake_transactions * BENCH_SCAN_RATE / BENCH_SCANS), (unsigned long) bench_events);
+}
+
+// Release all keys and let the debouncing settle
+static void bench_release(pcf8574_keypad_s *keypad){
+    fake_pressed = 0;
+    for (int i = 0; i < 5; i++)
+        pcf8574_keypad_scan(keypad);
+}
+
+int main(void){
+    pcf8574_config_s device;
+    pcf8574_keypad_s keypad;
+    
+    pcf8574_configure(&device, 0x20, fake_write, fake_read);
+    
+    pcf8574_keypad_init(&keypad, &device, 2, false, bench_key, NULL);
+    bench_run("idle, polled", &keypad, 0);
+    bench_run("one key", &keypad, KEYPAD_KEY(1, 2));
+    bench_release(&keypad);
+    bench_run("two keys in one row", &keypad, KEYPAD_KEY(2, 0) | KEYPAD_KEY(2, 3));
+    bench_release(&keypad);
+    bench_run("keys in 2 rows and 2 columns", &keypad, KEYPAD_KEY(0, 0) | KEYPAD_KEY(3, 1));
+    bench_release(&keypad);
+    bench_run("ghost rectangle (3 keys)", &keypad, KEYPAD_KEY(0, 0) | KEYPAD_KEY(0, 1) | KEYPAD_KEY(1, 0));
+    bench_release(&keypad);
+    
+    pcf8574_keypad_init(&keypad, &device, 2, true, bench_key, NULL);
+    bench_run("idle, INT wakeup", &keypad, 0);
+    return 0;
+}
@@ -0,0 +1,60 @@
+// Host benchmark of the delay shortening by the interface latency (min_latency_us)
+// A fixed sequence of driver calls is timed with full delays and with the latency of the PCF8574 subtracted
+// Build and run from this directory:
+//   gcc -std=c99 -O1 -I. -I.. -DDELAY_H -o latency_bench latency_bench.c hd44780_sim.c ../lcd.c ../PCF8574.c ../lcd_charset.c && ./latency_bench
+
+#include <stdio.h>
+#include <string.h>
+#include "lcd.h"
+#include "PCF8574.h"
+#include "hd44780_sim.h"
+
+static const uint32_t bench_bus_hz[] = {100000, 400000};
+
+// Run the sequence, returns the time in us and the visible rows
+static uint32_t bench_run(uint32_t bus_hz, bool burst, bool latency, char *rows){
+    lcd_config_s lcd_config;
+    pcf8574_config_s expander_config;
+    interface_s lcd_interface;
+    
+    sim_reset(false);
+    pcf8574_configure(&expander_config, 0x27, &sim_i2c_write, &sim_i2c_read);
+    lcd_configure(&lcd_config, LCD_BUS_WIDTH_4, LCD_FONT_5x8, 2, 16, LCD_MODE_WRAP);
+    lcd_interface_init(&lcd_interface, &expander_config, &pcf8574_lcd_if_write, &pcf8574_lcd_if_read);
+    if (burst){
+        lcd_interface.write_burst_fun = &pcf8574_lcd_if_write_burst;
+        lcd_interface.burst_edge_us = pcf8574_lcd_if_burst_edge_us(bus_hz);
+    }
+    if (latency)
+        lcd_interface.min_latency_us = pcf8574_lcd_if_latency_us(bus_hz);
+    lcd_init(&lcd_config, &lcd_interface);
+    
+    uint32_t transactions = sim.transactions;
+    uint32_t bytes = sim.bytes;
+    uint32_t delay = sim.delay_us;
+    lcd_printf_at(&lcd_config, &lcd_interface, "The quick brown fox jumps over t", 0, 0);
+    lcd_mv_cursor(&lcd_config, &lcd_interface, 1, 3);
+    lcd_putc(&lcd_config, &lcd_interface, '#');
+    lcd_get_cursor(&lcd_config, &lcd_interface);
+    
+    sim_row(0, 0x00, 16, rows);
+    sim_row(0, 0x40, 16, rows + 16);
+    return sim_wire_us(sim.transactions - transactions, sim.bytes - bytes, bus_hz) + sim.delay_us - delay;
+}
+
+int main(void){
+    char full_rows[33], short_rows[33];
+    
+    for (uint8_t i = 0; i < sizeof(bench_bus_hz) / sizeof(bench_bus_hz[0]); i++){
+        for (uint8_t burst = 0; burst < 2; burst++){
+            uint32_t full_us = bench_run(bench_bus_hz[i], burst, false, full_rows);
+            uint32_t short_us = bench_run(bench_bus_hz[i], burst, true, short_rows);
+            
+            printf("%3lu kHz %-9s latency %3u us: %6.1f ms full delays, %6.1f ms shortened (%4.1f %% less), display %s\n",
+                   (unsigned long) bench_bus_hz[i] / 1000, burst ? "burst" : "per-edge", pcf8574_lcd_if_latency_us(bench_bus_hz[i]),
+                   full_us / 1000.0, short_us / 1000.0, 100.0 * (full_us - short_us) / full_us,
+                   strcmp(full_rows, short_rows) ? "DIFFERENT" : "same");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+// Host benchmark of the bus error handling: a run of failed I2C transactions is injected at every position of a
+// fixed sequence of driver calls, the display is compared with a run without failures afterwards
+// Build and run from this directory:
+//   gcc -std=c99 -O1 -I. -I.. -DDELAY_H -o recovery_bench recovery_bench.c hd44780_sim.c ../lcd.c ../PCF8574.c ../lcd_charset.c && ./recovery_bench
+
+#include <stdio.h>
+#include "lcd.h"
+#include "PCF8574.h"
+#include "hd44780_sim.h"
+
+#define BENCH_BUS_HZ        100000
+#define BENCH_POSITIONS     150     // Failure positions per case, spread over the sequence
+
+static const char *bench_text = "Fault tolerant text across all rows of the panel, 0123456789 abcdefghijklmnopqrstuvwxyz";
+static const uint8_t bench_glyph[8] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02};
+static const uint32_t bench_lengths[] = {1, 2, 3, 4, 6, 8, 40};
+
+typedef struct{
+    lcd_geometry_e geometry;
+    bool burst;
+    bool flip;
+    const char *name;
+}bench_case_s;
+
+static const bench_case_s bench_cases[] = {
+    {LCD_GEOMETRY_16x2, false, false, "16x2 per-edge"},
+    {LCD_GEOMETRY_16x2, true, false, "16x2 burst"},
+    {LCD_GEOMETRY_16x2, true, true, "16x2 burst, page flip"},
+    {LCD_GEOMETRY_20x4, false, false, "20x4 per-edge"},
+    {LCD_GEOMETRY_20x4, true, false, "20x4 burst"},
+    {LCD_GEOMETRY_40x4, false, false, "40x4 per-edge"},
+    {LCD_GEOMETRY_40x4, true, false, "40x4 burst"},
+};
+
+static lcd_config_s lcd_config;
+static pcf8574_config_s expander_config;
+static interface_s lcd_interface;
+
+static void bench_setup(const bench_case_s *c){
+    sim_reset(lcd_geometry_table[c->geometry].controllers > 1);
+    pcf8574_configure(&expander_config, 0x27, &sim_i2c_write, &sim_i2c_read);
+    pcf8574_configure_dual(&expander_config, sim.dual);
+    lcd_configure_geometry(&lcd_config, LCD_BUS_WIDTH_4, LCD_FONT_5x8, &lcd_geometry_table[c->geometry], LCD_MODE_WRAP);
+    lcd_interface_init(&lcd_interface, &expander_config, &pcf8574_lcd_if_write, &pcf8574_lcd_if_read);
+    if (c->burst){
+        lcd_interface.write_burst_fun = &pcf8574_lcd_if_write_burst;
+        lcd_interface.burst_edge_us = pcf8574_lcd_if_burst_edge_us(BENCH_BUS_HZ);
+    }
+    lcd_init(&lcd_config, &lcd_interface);
+}
+
+// Driver calls under test, false if any of them reported a failure
+static bool bench_sequence(const bench_case_s *c){
+    bool ok = true;
+    
+    if (c->flip)
+        ok = (lcd_double_buffer(&lcd_config, &lcd_interface, true) == 0) && ok;
+    ok = lcd_create_custom(&lcd_config, &lcd_interface, 3, bench_glyph) && ok;
+    ok = lcd_printf_at(&lcd_config, &lcd_interface, (char *) bench_text, 0, 1) && ok;
+    ok = lcd_cursor_on(&lcd_config, &lcd_interface) && ok;
+    if (c->flip){
+        ok = lcd_page_flip(&lcd_config, &lcd_interface) && ok;
+        ok = lcd_printf_at(&lcd_config, &lcd_interface, "second page", 1, 2) && ok;
+    }
+    ok = lcd_putc(&lcd_config, &lcd_interface, '#') && ok;
+    return ok;
+}
+
+// Time of the sequence since the counters were taken
+static uint32_t bench_time_us(uint32_t transactions, uint32_t bytes, uint32_t delay_us){
+    return sim_wire_us(sim.transactions - transactions, sim.bytes - bytes, BENCH_BUS_HZ) + sim.delay_us - delay_us;
+}
+
+int main(void){
+    static const char *modes[] = {"NACK", "latched", "first byte"};
+    static sim_s reference;
+    uint32_t unreported = 0;
+    
+    for (uint8_t k = 0; k < sizeof(bench_cases) / sizeof(bench_cases[0]); k++){
+        const bench_case_s *c = &bench_cases[k];
+        
+        // Run without failures
+        bench_setup(c);
+        uint32_t start = sim.transactions;
+        uint32_t bytes = sim.bytes;
+        uint32_t delay = sim.delay_us;
+        bool ok = bench_sequence(c);
+        uint32_t span = sim.transactions - start;
+        uint32_t base_us = bench_time_us(start, bytes, delay);
+        reference = sim;
+        
+        // Alternative to recovery: initialize again and repeat everything
+        bench_setup(c);
+        uint32_t init_us = sim_wire_us(sim.transactions, sim.bytes, BENCH_BUS_HZ) + sim.delay_us;
+        printf("%s: %lu transactions, %.1f ms without failures (%s), init and redraw %.1f ms\n", c->name,
+               (unsigned long) span, base_us / 1000.0, ok ? "ok" : "FAILED", (init_us + base_us) / 1000.0);
+        
+        for (uint8_t mode = SIM_FAIL_NACK; mode <= SIM_FAIL_FIRST_BYTE; mode++){
+            for (uint8_t l = 0; l < sizeof(bench_lengths) / sizeof(bench_lengths[0]); l++){
+                uint32_t runs = 0, recovered = 0, reported = 0, repeated = 0, silent = 0;
+                uint32_t extra_sum = 0, extra_max = 0;
+                
+                for (uint32_t at = 0; at < span; at += span / BENCH_POSITIONS + 1){
+                    bench_setup(c);
+                    start = sim.transactions;
+                    bytes = sim.bytes;
+                    delay = sim.delay_us;
+                    sim.fail_mode = (sim_fail_e) mode;
+                    sim.fail_at = start + at;
+                    sim.fail_len = bench_lengths[l];
+                    ok = bench_sequence(c);
+                    uint32_t us = bench_time_us(start, bytes, delay);
+                    sim.fail_len = 0;
+                    runs++;
+                    
+                    if (sim_same_display(&sim, &reference)){
+                        // Handled inside the driver, the caller saw nothing but extra time
+                        recovered++;
+                        extra_sum += (us > base_us) ? us - base_us : 0;
+                        if (us > base_us && us - base_us > extra_max)
+                            extra_max = us - base_us;
+                    }
+                    else if (!ok){
+                        // Caller was told, repeating the calls has to restore the display
+                        reported++;
+                        if (!c->flip && bench_sequence(c) && sim_same_display(&sim, &reference))
+                            repeated++;
+                    }
+                    else
+                        silent++;
+                }
+                unreported += silent;
+                printf("  %-10s %2lu failed: %3lu runs, %3lu recovered (extra avg %5.1f ms, max %5.1f ms), "
+                       "%3lu reported (%3lu fixed by repeating), %lu wrong without report\n",
+                       modes[mode], (unsigned long) bench_lengths[l], (unsigned long) runs, (unsigned long) recovered,
+                       recovered ? extra_sum / 1000.0 / recovered : 0.0, extra_max / 1000.0, (unsigned long) reported,
+                       (unsigned long) repeated, (unsigned long) silent);
+            }
+        }
+    }
+    printf("wrong display without report: %lu\n", (unsigned long) unreported);
+    return unreported ? 1 : 0;
+}
@@ -0,0 +1,95 @@
+// Host comparison of lcd_static.h with the generic driver for a 16x2 panel behind a PCF8574
+// The same file is built once per variant, BENCH_STATIC selects lcd_static.h
+// Build and run from this directory:
+//   gcc -std=c99 -Os -ffunction-sections -fdata-sections -Wl,--gc-sections -I. -I.. -DDELAY_H -o static_bench_generic static_bench.c hd44780_sim.c ../lcd.c ../PCF8574.c ../lcd_charset.c && ./static_bench_generic
+//   gcc -std=c99 -Os -ffunction-sections -fdata-sections -Wl,--gc-sections -I. -I.. -DDELAY_H -DBENCH_STATIC -o static_bench_static static_bench.c hd44780_sim.c && ./static_bench_static
+// Code size of the driver: difference of the text sizes, e.g. size static_bench_generic static_bench_static
+
+#include <stdio.h>
+#include <time.h>
+#include "hd44780_sim.h"
+
+#define BENCH_ITERATIONS    2000000
+#define BENCH_BUS_HZ        100000
+
+// Timed runs skip the simulator, so only the time spent in the driver is measured
+static bool bench_null_bus;
+
+static bool bench_write(uint16_t addr, uint8_t *data, uint32_t len){
+    if (bench_null_bus)
+        return true;
+    return sim_i2c_write(addr, data, len);
+}
+
+#ifdef BENCH_STATIC
+#define LCD_STATIC_I2C_WRITE    bench_write
+#define LCD_STATIC_I2C_ADDR     0x27
+#define LCD_STATIC_EXTERN_DELAY
+#include "lcd_static.h"
+
+#define BENCH_VARIANT           "lcd_static.h"
+
+static void bench_init(void){
+    lcd_static_init();
+}
+
+static void bench_print(const char *s, uint8_t row, uint8_t col){
+    lcd_static_printf_at(s, row, col);
+}
+
+static void bench_putc(char c){
+    lcd_static_putc(c);
+}
+#else
+#include "lcd.h"
+#include "PCF8574.h"
+
+#define BENCH_VARIANT           "lcd.c"
+
+static lcd_config_s lcd_config;
+static pcf8574_config_s expander_config;
+static interface_s lcd_interface;
+
+static void bench_init(void){
+    pcf8574_configure(&expander_config, 0x27, &bench_write, &sim_i2c_read);
+    lcd_configure(&lcd_config, LCD_BUS_WIDTH_4, LCD_FONT_5x8, 2, 16, LCD_MODE_WRAP);
+    lcd_interface_init(&lcd_interface, &expander_config, &pcf8574_lcd_if_write, &pcf8574_lcd_if_read);
+    lcd_init(&lcd_config, &lcd_interface);
+}
+
+static void bench_print(const char *s, uint8_t row, uint8_t col){
+    lcd_printf_at(&lcd_config, &lcd_interface, (char *) s, row, col);
+}
+
+static void bench_putc(char c){
+    lcd_putc(&lcd_config, &lcd_interface, c);
+}
+#endif
+
+int main(void){
+    char rows[2][17];
+    
+    // Display content and bus traffic on the simulator
+    sim_reset(false);
+    bench_init();
+    uint32_t transactions = sim.transactions;
+    uint32_t bytes = sim.bytes;
+    uint32_t delay = sim.delay_us;
+    bench_putc('x');
+    uint32_t putc_us = sim_wire_us(sim.transactions - transactions, sim.bytes - bytes, BENCH_BUS_HZ) + sim.delay_us - delay;
+    printf("%s: putc %lu transactions, %lu us delays, %.2f ms at 100 kHz\n", BENCH_VARIANT,
+           (unsigned long) (sim.transactions - transactions), (unsigned long) (sim.delay_us - delay), putc_us / 1000.0);
+    
+    bench_print("Hello static world, wraps!", 0, 3);
+    sim_row(0, 0x00, 16, rows[0]);
+    sim_row(0, 0x40, 16, rows[1]);
+    printf("  display |%s|%s|\n", rows[0], rows[1]);
+    
+    // Processor time per character without bus
+    bench_null_bus = true;
+    clock_t start = clock();
+    for (long i = 0; i < BENCH_ITERATIONS; i++)
+        bench_putc((char) ('A' + (i & 15)));
+    printf("  %.1f ns per putc on this host\n", (double) (clock() - start) / CLOCKS_PER_SEC * 1e9 / BENCH_ITERATIONS);
+    return 0;
+}
@@ -1,6 +1,7 @@
 #define F_CPU 8000000UL
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "lcd.h"
 #include "delay.h"
@@ -8,137 +9,570 @@
 
 /* Low-level functions */
 
-static void lcd_write(const lcd_config_s *config, interface_s *interface, uint8_t cmd, uint8_t is_data){
+// Wait before the next write, its transfer time until the outputs change counts towards the delay
+static void lcd_delay(const interface_s *interface, uint32_t us){
+    if (us > interface->min_latency_us)
+        delay_usec(us - interface->min_latency_us);
+}
+
+// Mask of all controllers of the configured panel
+static uint8_t lcd_ctrl_all(const lcd_config_s *config){
+    return (config->geometry.controllers > 1) ? LCD_CTRL_ALL : LCD_CTRL_0;
+}
+
+// Set the enable lines of the selected controllers to the given level
+static void lcd_enable(lcd_cmd_s *lcd_cmd, uint8_t ctrl, uint8_t level){
+    lcd_cmd->e = (ctrl & LCD_CTRL_0) ? level : 0;
+    lcd_cmd->e2 = (ctrl & LCD_CTRL_1) ? level : 0;
+}
+
+// Set the output lines, repeated on failure
+// Writing the same levels again causes no additional edge
+static bool lcd_out(interface_s *interface, lcd_cmd_s lcd_cmd){
+    for (uint8_t i = 0; i < LCD_IO_RETRIES; i++){
+        if (interface->write_fun(interface->config, lcd_cmd))
+            return true;
+    }
+    return false;
+}
+
+// Sample the data lines, repeated on failure
+static bool lcd_in(interface_s *interface, uint8_t *data){
+    for (uint8_t i = 0; i < LCD_IO_RETRIES; i++){
+        if (interface->read_fun(interface->config, data))
+            return true;
+    }
+    return false;
+}
+
+// Clock a byte into the selected controllers, exec_us is waited together with the final hold time
+// Pass 0 if the next byte goes to another controller or its own transfer covers the execution time
+// Returns false if an edge was lost, the controllers may then wait for a lower nibble
+static bool lcd_clock(interface_s *interface, lcd_bit_e bus_width, uint8_t cmd, uint8_t is_data, uint8_t ctrl, uint32_t exec_us){
     // Empty LCD command
     lcd_cmd_s lcd_cmd;
     lcd_cmd.data = 0x00;
     lcd_cmd.ledk = 1;
     lcd_cmd.rs = is_data;
     lcd_cmd.rw = 0;
-    lcd_cmd.e = 1;
+    lcd_enable(&lcd_cmd, ctrl, 1);
     
-    if (config->bus_width == LCD_BUS_WIDTH_4){
+    if (bus_width == LCD_BUS_WIDTH_4){
         // Set control lines
-        lcd_cmd.e = 0;
-        interface->write_fun(interface->config, lcd_cmd);
-        delay_usec(DATA_OUTPUT_DELAY_US);
-        lcd_cmd.e = 1;
-        interface->write_fun(interface->config, lcd_cmd);
-        delay_usec(DATA_OUTPUT_DELAY_US);
+        lcd_enable(&lcd_cmd, ctrl, 0);
+        if (!lcd_out(interface, lcd_cmd))
+            return false;
+        lcd_delay(interface, DATA_OUTPUT_DELAY_US);
+        lcd_enable(&lcd_cmd, ctrl, 1);
+        if (!lcd_out(interface, lcd_cmd))
+            return false;
+        lcd_delay(interface, DATA_OUTPUT_DELAY_US);
         
         // Send upper nibble
         lcd_cmd.data = cmd & 0xf0;
-        interface->write_fun(interface->config, lcd_cmd);
-        delay_usec(LEVEL_DELAY_US);
+        if (!lcd_out(interface, lcd_cmd))
+            return false;
+        lcd_delay(interface, LEVEL_DELAY_US);
         
         // High-low transition on Enable bit
-        lcd_cmd.e = 0;
-        interface->write_fun(interface->config, lcd_cmd);
-        delay_usec(DATA_HOLD_DELAY_US);
+        lcd_enable(&lcd_cmd, ctrl, 0);
+        if (!lcd_out(interface, lcd_cmd))
+            return false;
+        lcd_delay(interface, DATA_HOLD_DELAY_US);
         
         // Send lower nibble
-        lcd_cmd.e = 1;
+        lcd_enable(&lcd_cmd, ctrl, 1);
         lcd_cmd.data = (cmd & 0x0f) << 4;
-        interface->write_fun(interface->config, lcd_cmd);
-        delay_usec(LEVEL_DELAY_US);
+        if (!lcd_out(interface, lcd_cmd))
+            return false;
+        lcd_delay(interface, LEVEL_DELAY_US);
         // High-low transition on Enable bit
-        lcd_cmd.e = 0;
-        interface->write_fun(interface->config, lcd_cmd);
-        delay_usec(DATA_HOLD_DELAY_US);
+        lcd_enable(&lcd_cmd, ctrl, 0);
+        if (!lcd_out(interface, lcd_cmd))
+            return false;
+        lcd_delay(interface, DATA_HOLD_DELAY_US + exec_us);
     }
     else{
         // Send command word at once
         lcd_cmd.data = cmd;
-        interface->write_fun(interface->config, lcd_cmd);
-        delay_usec(LEVEL_DELAY_US);
+        if (!lcd_out(interface, lcd_cmd))
+            return false;
+        lcd_delay(interface, LEVEL_DELAY_US);
         
         // High-low transition on Enable bit
-        lcd_cmd.e = 0;
-        interface->write_fun(interface->config, lcd_cmd);
-        delay_usec(DATA_HOLD_DELAY_US);
+        lcd_enable(&lcd_cmd, ctrl, 0);
+        if (!lcd_out(interface, lcd_cmd))
+            return false;
+        lcd_delay(interface, DATA_HOLD_DELAY_US + exec_us);
     }
-    
-    delay_usec(CMD_DELAY_US);
+    return true;
 }
 
-static uint8_t lcd_read(const lcd_config_s *config, interface_s *interface, uint8_t is_data){
+// Read a byte from a single controller, false if an edge or the sampling was lost
+static bool lcd_fetch(interface_s *interface, lcd_bit_e bus_width, uint8_t is_data, uint8_t ctrl, uint8_t *value){
     // Empty LCD command
     lcd_cmd_s lcd_cmd;
     lcd_cmd.data = 0xff;
     lcd_cmd.ledk = 1;
     lcd_cmd.rs = is_data;
     lcd_cmd.rw = 1;
-    lcd_cmd.e = 1;
-    uint8_t read_value;
+    lcd_enable(&lcd_cmd, ctrl, 1);
+    uint8_t data;
 
-    if (config->bus_width == LCD_BUS_WIDTH_4){
+    if (bus_width == LCD_BUS_WIDTH_4){
         // Set control lines
-        lcd_cmd.e = 0;
-        interface->write_fun(interface->config, lcd_cmd);
-        delay_usec(DATA_OUTPUT_DELAY_US);
-        lcd_cmd.e = 1;
-        interface->write_fun(interface->config, lcd_cmd);
+        lcd_enable(&lcd_cmd, ctrl, 0);
+        if (!lcd_out(interface, lcd_cmd))
+            return false;
+        lcd_delay(interface, DATA_OUTPUT_DELAY_US);
+        lcd_enable(&lcd_cmd, ctrl, 1);
+        if (!lcd_out(interface, lcd_cmd))
+            return false;
         delay_usec(DATA_OUTPUT_DELAY_US);
         
         // Read upper nibble
-        read_value = interface->read_fun(interface->config) & 0xF0;
+        if (!lcd_in(interface, &data))
+            return false;
+        *value = data & 0xF0;
         
         // High-low transition on Enable bit
-        lcd_cmd.e = 0;
-        interface->write_fun(interface->config, lcd_cmd);
-        delay_usec(DATA_HOLD_DELAY_US);
+        lcd_enable(&lcd_cmd, ctrl, 0);
+        if (!lcd_out(interface, lcd_cmd))
+            return false;
+        lcd_delay(interface, DATA_HOLD_DELAY_US);
         
         // Set control lines
-        lcd_cmd.e = 1;
-        interface->write_fun(interface->config, lcd_cmd);
+        lcd_enable(&lcd_cmd, ctrl, 1);
+        if (!lcd_out(interface, lcd_cmd))
+            return false;
         delay_usec(DATA_OUTPUT_DELAY_US);
         
         // Read lower nibble
-        read_value |= (interface->read_fun(interface->config) & 0xF0) >> 4;
+        if (!lcd_in(interface, &data))
+            return false;
+        *value |= (data & 0xF0) >> 4;
 
         // High-low transition on Enable bit
-        lcd_cmd.e = 0;
-        interface->write_fun(interface->config, lcd_cmd);
-        delay_usec(DATA_HOLD_DELAY_US);
+        lcd_enable(&lcd_cmd, ctrl, 0);
+        if (!lcd_out(interface, lcd_cmd))
+            return false;
+        lcd_delay(interface, DATA_HOLD_DELAY_US);
     }
     else{
         // Set control lines
-        interface->write_fun(interface->config, lcd_cmd);
+        if (!lcd_out(interface, lcd_cmd))
+            return false;
         delay_usec(DATA_OUTPUT_DELAY_US);
         
         // Read register at once
-        read_value = interface->read_fun(interface->config);
+        if (!lcd_in(interface, value))
+            return false;
         
         // High-low transition on Enable bit
-        lcd_cmd.e = 0;
-        interface->write_fun(interface->config, lcd_cmd);
-        delay_usec(DATA_HOLD_DELAY_US);
+        lcd_enable(&lcd_cmd, ctrl, 0);
+        if (!lcd_out(interface, lcd_cmd))
+            return false;
+        lcd_delay(interface, DATA_HOLD_DELAY_US);
+    }
+    return true;
+}
+
+// Function set command for the configured panel
+static uint8_t lcd_function_set(const lcd_config_s *config){
+    uint8_t cmd = LCD_FUNCTION_SET;
+    
+    cmd |= (config->bus_width == LCD_BUS_WIDTH_8) ? LCD_8BIT : LCD_4BIT;
+    cmd |= (config->geometry.ctrl_lines == 1) ? LCD_1_LINE : LCD_2_LINE;
+    cmd |= (config->font == LCD_FONT_5x8) ? LCD_5F8 : LCD_5F10;
+    return cmd;
+}
+
+// Address counter after one step in the given direction
+// DDRAM of two-line controllers continues from 0x27 at 0x40 and from 0x67 at 0x00
+static uint8_t lcd_shadow_step(const lcd_config_s *config, uint8_t addr, int8_t dir){
+    uint8_t index;
+    
+    if (addr & LCD_SHADOW_CGRAM)
+        return LCD_SHADOW_CGRAM | ((addr + dir) & 0x3f);
+    if (config->geometry.ctrl_lines == 1)
+        return (addr + dir + 80) % 80;
+    
+    index = (addr >= LCD_LINE1_ADDR) ? 40 + (addr - LCD_LINE1_ADDR) : addr;
+    index = (index + dir + 80) % 80;
+    return (index < 40) ? index : LCD_LINE1_ADDR + (index - 40);
+}
+
+// Follow address counters and display shift for an acknowledged byte
+static void lcd_shadow_update(lcd_config_s *config, uint8_t cmd, uint8_t is_data, uint8_t ctrl){
+    for (uint8_t i = 0; i < MAX_CTRL_SUPPORTED; i++){
+        uint8_t *addr = &config->shadow_addr[i];
+        
+        if (!(ctrl & (LCD_CTRL_0 << i)))
+            continue;
+        if (is_data)
+            *addr = lcd_shadow_step(config, *addr, 1);
+        else if (cmd & LCD_SET_DDRAM_ADDR)
+            *addr = cmd & 0x7f;
+        else if (cmd & LCD_SET_CGRAM_ADDR)
+            *addr = LCD_SHADOW_CGRAM | (cmd & 0x3f);
+        else if (cmd & LCD_FUNCTION_SET)
+            continue;
+        else if ((cmd & LCD_CURSOR_SHIFT) && !(cmd & LCD_DISPLAYMOVE))
+            *addr = lcd_shadow_step(config, *addr, (cmd & LCD_MOVERIGHT) ? 1 : -1);
+        else if (cmd == LCD_CLEAR_DISPLAY || (cmd & ~0x01) == LCD_RETURN_HOME)
+            *addr = 0;
+    }
+    
+    // Display shift is the same on all controllers
+    if (is_data || (cmd & 0xE0))
+        return;
+    if ((cmd & LCD_CURSOR_SHIFT) && (cmd & LCD_DISPLAYMOVE))
+        config->shadow_shift = (cmd & LCD_MOVERIGHT) ? (config->shadow_shift + 39) % 40 : (config->shadow_shift + 1) % 40;
+    else if (cmd == LCD_CLEAR_DISPLAY || (cmd & ~0x01) == LCD_RETURN_HOME)
+        config->shadow_shift = 0;
+}
+
+// Realign the 4-bit transfer and return the controllers to the last acknowledged state
+static bool lcd_resync(const lcd_config_s *config, interface_s *interface){
+    uint8_t ctrl_all = lcd_ctrl_all(config);
+    uint8_t others = ctrl_all & ~config->active_ctrl;
+    bool ok = true;
+    
+    if (config->bus_width == LCD_BUS_WIDTH_4){
+        // Three single nibbles 0x3 end in 8-bit mode whether a lower nibble was expected or not
+        // A pending upper nibble is completed by the first one to a command with lower nibble 0x3
+        for (uint8_t i = 0; i < 3; i++)
+            ok = ok && lcd_clock(interface, LCD_BUS_WIDTH_8, LCD_FUNCTION_SET | LCD_8BIT, 0, ctrl_all, RESYNC_DELAY_US);
+        // Back to 4-bit mode with a single nibble 0x2
+        ok = ok && lcd_clock(interface, LCD_BUS_WIDTH_8, LCD_FUNCTION_SET | LCD_4BIT, 0, ctrl_all, RESYNC_DELAY_US);
+    }
+    
+    // A misaligned command may have changed function set, address and display shift
+    // Display control and entry mode are rewritten as the state of a half byte is unknown
+    ok = ok && lcd_clock(interface, config->bus_width, lcd_function_set(config), 0, ctrl_all, RESYNC_DELAY_US);
+    ok = ok && lcd_clock(interface, config->bus_width, LCD_DISPLAY_CONTROL | config->state_display_control, 0, config->active_ctrl, RESYNC_DELAY_US);
+    if (others)
+        ok = ok && lcd_clock(interface, config->bus_width, LCD_DISPLAY_CONTROL | (config->state_display_control & LCD_DISPLAY_ON), 0, others, RESYNC_DELAY_US);
+    ok = ok && lcd_clock(interface, config->bus_width, LCD_ENTRY_MODE_SET | LCD_INCREMENT | LCD_NO_SHIFT, 0, ctrl_all, RESYNC_DELAY_US);
+    
+    // Restore display shift from zero
+    ok = ok && lcd_clock(interface, config->bus_width, LCD_RETURN_HOME, 0, ctrl_all, RESYNC_DELAY_US);
+    for (uint8_t i = 0; i < config->shadow_shift; i++)
+        ok = ok && lcd_clock(interface, config->bus_width, LCD_CURSOR_SHIFT | LCD_DISPLAYMOVE | LCD_MOVELEFT, 0, ctrl_all,
+                             (i + 1 == config->shadow_shift) ? RESYNC_DELAY_US : 0);
+    
+    // Restore address counters
+    for (uint8_t i = 0; (LCD_CTRL_0 << i) & ctrl_all; i++){
+        uint8_t addr = config->shadow_addr[i];
+        uint8_t cmd = (addr & LCD_SHADOW_CGRAM) ? LCD_SET_CGRAM_ADDR | (addr & 0x3f) : LCD_SET_DDRAM_ADDR | addr;
+        ok = ok && lcd_clock(interface, config->bus_width, cmd, 0, LCD_CTRL_0 << i, RESYNC_DELAY_US);
+    }
+    return ok;
+}
+
+// Resynchronise after a lost transfer, false once all attempts are used
+// A failed recovery is repeated before the next transfer, the controllers may be misaligned until then
+static bool lcd_recover(lcd_config_s *config, interface_s *interface, uint8_t *attempts){
+    do{
+        if (++(*attempts) > LCD_RESYNC_ATTEMPTS){
+            config->resync_pending = true;
+            return false;
+        }
+    } while (!lcd_resync(config, interface));
+    config->resync_pending = false;
+    return true;
+}
+
+// Clock a byte into the selected controllers, resend it after a resynchronisation if it was lost
+static bool lcd_send(lcd_config_s *config, interface_s *interface, uint8_t cmd, uint8_t is_data, uint8_t ctrl, uint32_t exec_us){
+    uint8_t attempts = 0;
+    
+    if (config->resync_pending && !lcd_recover(config, interface, &attempts))
+        return false;
+    while (!lcd_clock(interface, config->bus_width, cmd, is_data, ctrl, exec_us)){
+        if (!lcd_recover(config, interface, &attempts))
+            return false;
+    }
+    lcd_shadow_update(config, cmd, is_data, ctrl);
+    return true;
+}
+
+// Clock a byte into the selected controllers and wait for its execution
+static bool lcd_write_ctrl(lcd_config_s *config, interface_s *interface, uint8_t cmd, uint8_t is_data, uint8_t ctrl){
+    return lcd_send(config, interface, cmd, is_data, ctrl, CMD_DELAY_US);
+}
+
+// Clock a burst of bytes, false if any transfer failed
+// Every byte but the last is followed by hold copies of its last command, they stretch the burst without an edge
+static bool lcd_clock_burst(const lcd_config_s *config, interface_s *interface, const uint8_t *buf, uint16_t n, uint8_t is_data, uint8_t ctrl, uint8_t hold){
+    // Settle RS plus two edges per nibble for every byte, lcd_stream() limits n to the size including hold commands
+    lcd_cmd_s lcd_cmds[1 + 4 * LCD_BURST_BYTES];
+    lcd_cmd_s lcd_cmd;
+    uint16_t count = 0;
+    lcd_cmd.ledk = 1;
+    lcd_cmd.rs = is_data;
+    lcd_cmd.rw = 0;
+    
+    // RS is set up before the first rising edge
+    lcd_cmd.data = 0x00;
+    lcd_enable(&lcd_cmd, ctrl, 0);
+    lcd_cmds[count++] = lcd_cmd;
+    
+    for (uint16_t i = 0; i < n; i++){
+        if (config->bus_width == LCD_BUS_WIDTH_4){
+            // Upper nibble with high-low transition on Enable bit
+            lcd_cmd.data = buf[i] & 0xf0;
+            lcd_enable(&lcd_cmd, ctrl, 1);
+            lcd_cmds[count++] = lcd_cmd;
+            lcd_enable(&lcd_cmd, ctrl, 0);
+            lcd_cmds[count++] = lcd_cmd;
+            
+            // Lower nibble
+            lcd_cmd.data = (buf[i] & 0x0f) << 4;
+        }
+        else
+            lcd_cmd.data = buf[i];
+        lcd_enable(&lcd_cmd, ctrl, 1);
+        lcd_cmds[count++] = lcd_cmd;
+        lcd_enable(&lcd_cmd, ctrl, 0);
+        lcd_cmds[count++] = lcd_cmd;
+        
+        // Wait for the execution before the next byte
+        for (uint8_t j = 0; j < hold && i + 1 < n; j++)
+            lcd_cmds[count++] = lcd_cmd;
+    }
+    return interface->write_burst_fun(interface->config, lcd_cmds, count);
+}
+
+// Clock a sequence of data bytes or instructions into the selected controllers, waits once after the last byte
+// The execution time of every byte is covered by the edges of the next one
+static bool lcd_stream(lcd_config_s *config, interface_s *interface, const uint8_t *buf, uint16_t len, uint8_t is_data, uint8_t ctrl){
+    uint8_t edges = (config->bus_width == LCD_BUS_WIDTH_4) ? 4 : 2;
+    uint8_t hold = 0;
+    uint16_t burst_bytes = 0;
+    
+    if (len == 0)
+        return true;
+    
+    // Commands after the last edge of a byte until the execution time has passed (faster buses)
+    if (interface->write_burst_fun != NULL && interface->burst_edge_us > 0){
+        hold = (EXEC_DELAY_US + interface->burst_edge_us - 1) / interface->burst_edge_us - 1;
+        burst_bytes = (4 * LCD_BURST_BYTES) / (edges + hold);
+    }
+    
+    if (burst_bytes == 0){
+        // One transfer per edge
+        for (uint16_t i = 0; i < len; i++){
+            if (!lcd_send(config, interface, buf[i], is_data, ctrl, (i + 1 == len) ? CMD_DELAY_US : 0))
+                return false;
+        }
+        return true;
+    }
+    
+    while (len > 0){
+        uint16_t n = (len < burst_bytes) ? len : burst_bytes;
+        uint8_t attempts = 0;
+        
+        if (config->resync_pending && !lcd_recover(config, interface, &attempts))
+            return false;
+        // A burst is not repeatable edge by edge, the whole burst is resent from the restored address
+        while (!lcd_clock_burst(config, interface, buf, n, is_data, ctrl, hold)){
+            if (!lcd_recover(config, interface, &attempts))
+                return false;
+        }
+        for (uint16_t i = 0; i < n; i++)
+            lcd_shadow_update(config, buf[i], is_data, ctrl);
+        buf += n;
+        len -= n;
+    }
+    lcd_delay(interface, CMD_DELAY_US);
+    return true;
+}
+
+// Clock a byte into all controllers at once
+static bool lcd_write(lcd_config_s *config, interface_s *interface, uint8_t cmd, uint8_t is_data){
+    return lcd_write_ctrl(config, interface, cmd, is_data, lcd_ctrl_all(config));
+}
+
+// Read a byte from a single controller, the address counter is restored and the read repeated if it was lost
+static bool lcd_read(lcd_config_s *config, interface_s *interface, uint8_t is_data, uint8_t ctrl, uint8_t *value){
+    uint8_t attempts = 0;
+    
+    if (config->resync_pending && !lcd_recover(config, interface, &attempts))
+        return false;
+    while (!lcd_fetch(interface, config->bus_width, is_data, ctrl, value)){
+        if (!lcd_recover(config, interface, &attempts))
+            return false;
     }
-    return read_value;
+    return true;
 }
 
+// Read busy flag and address counter of a single controller
+static bool lcd_read_status(lcd_config_s *config, interface_s *interface, uint8_t ctrl, lcd_status_s *status){
+    uint8_t temp;
+    
+    if (!lcd_read(config, interface, 0, ctrl, &temp))
+        return false;
+    status->address = temp & ~(1 << 7);
+    status->busy = (temp >> 7) & 1;
+    return true;
+}
+
+// Get DDRAM address of a position, second segment of split rows is not continuous
+static uint8_t lcd_pos_addr(const lcd_geometry_s *geometry, uint8_t row, uint8_t col){
+    if (geometry->split_col > 0 && col >= geometry->split_col)
+        return geometry->split_addr[row] + (col - geometry->split_col);
+    return geometry->line_addr[row] + col;
+}
+
+// Get DDRAM address of a position on the page addressed by cursor functions
+static uint8_t lcd_page_addr(const lcd_config_s *config, uint8_t row, uint8_t col){
+    return lcd_pos_addr(&config->geometry, row, col) + config->draw_page * config->page_offset;
+}
+
+// Check if a second page of the given width fits behind every visible row segment
+static bool lcd_page_fits(const lcd_geometry_s *geometry, uint8_t width){
+    uint8_t line_len = (geometry->ctrl_lines > 1) ? 40 : 80;
+    uint8_t segments = (geometry->split_col > 0) ? 2 : 1;
+    
+    // Both halves of split rows are shifted by the same amount
+    if (geometry->split_col > 0 && geometry->cols - geometry->split_col != width)
+        return false;
+    
+    for (uint8_t row = 0; row < geometry->rows; row++){
+        for (uint8_t seg = 0; seg < segments; seg++){
+            uint8_t start = seg ? geometry->split_addr[row] : geometry->line_addr[row];
+            uint8_t line_base = (geometry->ctrl_lines > 1 && start >= LCD_LINE1_ADDR) ? LCD_LINE1_ADDR : LCD_LINE0_ADDR;
+            uint8_t hidden = start + width;
+            
+            // Hidden segment has to stay in the same DDRAM line
+            if (hidden + width > line_base + line_len)
+                return false;
+            
+            // Hidden segment must not overlap a visible segment of the same controller
+            for (uint8_t other = 0; other < geometry->rows; other++){
+                if (geometry->line_ctrl[other] != geometry->line_ctrl[row])
+                    continue;
+                for (uint8_t other_seg = 0; other_seg < segments; other_seg++){
+                    uint8_t visible = other_seg ? geometry->split_addr[other] : geometry->line_addr[other];
+                    if (hidden < visible + width && visible < hidden + width)
+                        return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Send display control state, only the controller holding the cursor shows cursor and blink
+static bool lcd_update_display_control(lcd_config_s *config, interface_s *interface){
+    uint8_t others = lcd_ctrl_all(config) & ~config->active_ctrl;
+    
+    if (!lcd_write_ctrl(config, interface, LCD_DISPLAY_CONTROL | config->state_display_control, 0, config->active_ctrl))
+        return false;
+    if (others)
+        return lcd_write_ctrl(config, interface, LCD_DISPLAY_CONTROL | (config->state_display_control & LCD_DISPLAY_ON), 0, others);
+    return true;
+}
+
+// Hand the cursor to another controller, cursor and blink follow if they are on
+static bool lcd_select_ctrl(lcd_config_s *config, interface_s *interface, uint8_t ctrl){
+    if (ctrl == config->active_ctrl)
+        return true;
+    config->active_ctrl = ctrl;
+    if (config->state_display_control & (LCD_CURSOR_ON | LCD_BLINK_ON))
+        return lcd_update_display_control(config, interface);
+    return true;
+}
+
+/* Geometry table */
+
+const lcd_geometry_s lcd_geometry_table[LCD_GEOMETRY_COUNT] = {
+    // rows, cols, lines per controller, controllers, split column, line addresses, split addresses, controllers per row
+    [LCD_GEOMETRY_8x1]          = {1,  8, 1, 1, 0, {LCD_LINE0_ADDR}, {0}, {LCD_CTRL_0}},
+    [LCD_GEOMETRY_16x1]         = {1, 16, 1, 1, 0, {LCD_LINE0_ADDR}, {0}, {LCD_CTRL_0}},
+    [LCD_GEOMETRY_16x1_SPLIT]   = {1, 16, 2, 1, 8, {LCD_LINE0_ADDR}, {LCD_LINE1_ADDR}, {LCD_CTRL_0}},
+    [LCD_GEOMETRY_8x2]          = {2,  8, 2, 1, 0, {LCD_LINE0_ADDR, LCD_LINE1_ADDR}, {0}, {LCD_CTRL_0, LCD_CTRL_0}},
+    [LCD_GEOMETRY_16x2]         = {2, 16, 2, 1, 0, {LCD_LINE0_ADDR, LCD_LINE1_ADDR}, {0}, {LCD_CTRL_0, LCD_CTRL_0}},
+    [LCD_GEOMETRY_20x2]         = {2, 20, 2, 1, 0, {LCD_LINE0_ADDR, LCD_LINE1_ADDR}, {0}, {LCD_CTRL_0, LCD_CTRL_0}},
+    [LCD_GEOMETRY_24x2]         = {2, 24, 2, 1, 0, {LCD_LINE0_ADDR, LCD_LINE1_ADDR}, {0}, {LCD_CTRL_0, LCD_CTRL_0}},
+    [LCD_GEOMETRY_40x2]         = {2, 40, 2, 1, 0, {LCD_LINE0_ADDR, LCD_LINE1_ADDR}, {0}, {LCD_CTRL_0, LCD_CTRL_0}},
+    // Rows 2 and 3 continue rows 0 and 1 behind the visible columns
+    [LCD_GEOMETRY_16x4]         = {4, 16, 2, 1, 0, {LCD_LINE0_ADDR, LCD_LINE1_ADDR, LCD_LINE0_ADDR + 16, LCD_LINE1_ADDR + 16}, {0},
+                                   {LCD_CTRL_0, LCD_CTRL_0, LCD_CTRL_0, LCD_CTRL_0}},
+    [LCD_GEOMETRY_20x4]         = {4, 20, 2, 1, 0, {LCD_LINE0_ADDR, LCD_LINE1_ADDR, LCD_LINE2_ADDR, LCD_LINE3_ADDR}, {0},
+                                   {LCD_CTRL_0, LCD_CTRL_0, LCD_CTRL_0, LCD_CTRL_0}},
+    // Upper and lower half are separate 40x2 controllers
+    [LCD_GEOMETRY_40x4]         = {4, 40, 2, 2, 0, {LCD_LINE0_ADDR, LCD_LINE1_ADDR, LCD_LINE0_ADDR, LCD_LINE1_ADDR}, {0},
+                                   {LCD_CTRL_0, LCD_CTRL_0, LCD_CTRL_1, LCD_CTRL_1}},
+};
+
 /* Misc. functions */
 
-void lcd_clear(const lcd_config_s *config, interface_s *interface){
-    lcd_write(config, interface, LCD_CLEAR_DISPLAY, 0);
-    wait_busy(config, interface);
+bool lcd_clear(lcd_config_s *config, interface_s *interface){
+    // All controllers are cleared at once and execute in parallel
+    if (!lcd_write(config, interface, LCD_CLEAR_DISPLAY, 0))
+        return false;
+    config->active_ctrl = LCD_CTRL_0;
+    config->front_page = 0;
+    config->draw_page = (config->page_offset > 0) ? 1 : 0;
+    return wait_busy(config, interface);
 }
 
-void lcd_home(const lcd_config_s *config, interface_s *interface){
-    lcd_write(config, interface, LCD_RETURN_HOME, 0);
-    wait_busy(config, interface);
+bool lcd_home(lcd_config_s *config, interface_s *interface){
+    if (!lcd_write(config, interface, LCD_RETURN_HOME, 0))
+        return false;
+    config->active_ctrl = LCD_CTRL_0;
+    config->front_page = 0;
+    config->draw_page = (config->page_offset > 0) ? 1 : 0;
+    return wait_busy(config, interface);
 }
 
-void wait_busy(const lcd_config_s *config, interface_s *interface){
+bool wait_busy(lcd_config_s *config, interface_s *interface){
     lcd_status_s status;  
-    do{
-        status = lcd_get_status(config, interface);
-    } while(status.busy);
+    uint8_t ctrl_all = lcd_ctrl_all(config);
+    
+    // Poll every controller, they may be executing at the same time
+    for (uint8_t ctrl = LCD_CTRL_0; ctrl & ctrl_all; ctrl <<= 1){
+        do{
+            if (!lcd_read_status(config, interface, ctrl, &status))
+                return false;
+        } while(status.busy);
+    }
+    return true;
 }
 
 /* Setup functions */
 
+void lcd_interface_init(interface_s *interface, void *interface_config, IF_Write_Fcn write_fun, IF_Read_Fcn read_fun){
+    interface->config = interface_config;
+    interface->write_fun = write_fun;
+    interface->read_fun = read_fun;
+    
+    // Optional fields, per-edge writes with full delays
+    interface->write_burst_fun = NULL;
+    interface->burst_edge_us = 0;
+    interface->min_latency_us = 0;
+}
+
 int lcd_configure(lcd_config_s *config, lcd_bit_e bus_width, lcd_font_e font, uint8_t rows, uint8_t cols, uint8_t mode){
+    // Generic layout for sizes not found in the table
+    lcd_geometry_s geometry = {rows, cols, (rows > 1) ? 2 : 1, 1, 0,
+                               {LCD_LINE0_ADDR, LCD_LINE1_ADDR, LCD_LINE2_ADDR, LCD_LINE3_ADDR}, {0},
+                               {LCD_CTRL_0, LCD_CTRL_0, LCD_CTRL_0, LCD_CTRL_0}};
+    
+    // Use first known layout of matching size
+    for (int i = 0; i < LCD_GEOMETRY_COUNT; i++){
+        if (lcd_geometry_table[i].rows == rows && lcd_geometry_table[i].cols == cols){
+            geometry = lcd_geometry_table[i];
+            break;
+        }
+    }
+    
+    return lcd_configure_geometry(config, bus_width, font, &geometry, mode);
+}
+
+int lcd_configure_geometry(lcd_config_s *config, lcd_bit_e bus_width, lcd_font_e font, const lcd_geometry_s *geometry, uint8_t mode){
     // Assign correct bus type
     switch(bus_width){
         // Intentional fall-through for all valid cases
@@ -164,34 +598,49 @@ int lcd_configure(lcd_config_s *config, lcd_bit_e bus_width, lcd_font_e font, ui
     }
     
     // Assign rows and columns
-    if (rows > 0 && rows <= MAX_ROWS_SUPPORTED && cols > 0){
-        config->rows = rows;
-        config->cols = cols;
+    if (geometry->rows > 0 && geometry->rows <= MAX_ROWS_SUPPORTED && geometry->cols > 0 && geometry->cols <= MAX_COLS_SUPPORTED &&
+        geometry->controllers > 0 && geometry->controllers <= MAX_CTRL_SUPPORTED){
+        config->rows = geometry->rows;
+        config->cols = geometry->cols;
+        config->geometry = *geometry;
     }  
     else 
         return -1;
     
     // Assign default states
     config->state_display_control = LCD_DISPLAY_ON;
+    config->active_ctrl = LCD_CTRL_0;
+    config->charset = NULL;
+    config->page_offset = 0;
+    config->front_page = 0;
+    config->draw_page = 0;
     config->mode = mode;
+    for (uint8_t i = 0; i < MAX_CTRL_SUPPORTED; i++)
+        config->shadow_addr[i] = 0;
+    config->shadow_shift = 0;
+    config->resync_pending = false;
     
     // All good
     return 0;
 }
 
-void lcd_init(lcd_config_s *config, interface_s * interface){  
+bool lcd_init(lcd_config_s *config, interface_s * interface){  
     uint8_t config_cmd = LCD_FUNCTION_SET;
     lcd_bit_e original_bus_width = config->bus_width;
+    bool ok;
     
     // Send 3x 0x30 with delays in between in 8-bit mode first
     // Delays are necessary because busy flag is still unavailable
+    // The sequence realigns the controllers itself, a pending resynchronisation is dropped
+    config->resync_pending = false;
     config->bus_width = LCD_BUS_WIDTH_8;
-    delay_usec(BOOT_DELAY_US);
-    lcd_write(config, interface, LCD_FUNCTION_SET | LCD_8BIT, 0);
+    lcd_delay(interface, BOOT_DELAY_US);
+    ok = lcd_write(config, interface, LCD_FUNCTION_SET | LCD_8BIT, 0);
+    // Full delays, the write before already took the transfer time off its own delay
     delay_usec(BOOT_DELAY_US/5);
-    lcd_write(config, interface, LCD_FUNCTION_SET | LCD_8BIT, 0);
+    ok = ok && lcd_write(config, interface, LCD_FUNCTION_SET | LCD_8BIT, 0);
     delay_usec(BOOT_DELAY_US/10);
-    lcd_write(config, interface, LCD_FUNCTION_SET | LCD_8BIT, 0);
+    ok = ok && lcd_write(config, interface, LCD_FUNCTION_SET | LCD_8BIT, 0);
     
     // Set bus width
     if (original_bus_width == LCD_BUS_WIDTH_8)
@@ -200,50 +649,49 @@ void lcd_init(lcd_config_s *config, interface_s * interface){
         config_cmd |= LCD_4BIT;
           
     // Set the mode
-    wait_busy(config, interface);
-    lcd_write(config, interface, config_cmd, 0);
+    ok = ok && wait_busy(config, interface);
+    ok = ok && lcd_write(config, interface, config_cmd, 0);
     
     // Reset bus to original bus width
     config->bus_width = original_bus_width;
     
-    // Set row configuration
-    if (config->rows == 1)
-        config_cmd |= LCD_1_LINE;
-    else
-        config_cmd |= LCD_2_LINE;
-
-    // Set font configuration
-    if (config->font == LCD_FONT_5x8)
-        config_cmd |= LCD_5F8;
-    else
-        config_cmd |= LCD_5F10;
-   
-    // Send the configuration command
-    wait_busy(config, interface);
-    lcd_write(config, interface, config_cmd, 0);
+    // Send the configuration command with row and font configuration
+    ok = ok && wait_busy(config, interface);
+    ok = ok && lcd_write(config, interface, lcd_function_set(config), 0);
 
     // Display on, no cursor, no blink
-    wait_busy(config, interface);
-    lcd_write(config, interface, LCD_DISPLAY_CONTROL | LCD_CURSOR_OFF | LCD_BLINK_OFF | LCD_DISPLAY_ON, 0);
+    ok = ok && wait_busy(config, interface);
+    ok = ok && lcd_write(config, interface, LCD_DISPLAY_CONTROL | LCD_CURSOR_OFF | LCD_BLINK_OFF | LCD_DISPLAY_ON, 0);
     
     // Clear display
-    wait_busy(config, interface);
-    lcd_write(config, interface, LCD_CLEAR_DISPLAY, 0);
+    ok = ok && wait_busy(config, interface);
+    ok = ok && lcd_write(config, interface, LCD_CLEAR_DISPLAY, 0);
     
     // Entry mode set
-    wait_busy(config, interface);
-    lcd_write(config, interface, LCD_ENTRY_MODE_SET | LCD_INCREMENT | LCD_NO_SHIFT, 0);
+    ok = ok && wait_busy(config, interface);
+    ok = ok && lcd_write(config, interface, LCD_ENTRY_MODE_SET | LCD_INCREMENT | LCD_NO_SHIFT, 0);
     
     // Home LCD
-    wait_busy(config, interface);
-    lcd_write(config, interface, LCD_RETURN_HOME, 0);
-    wait_busy(config, interface);
+    ok = ok && wait_busy(config, interface);
+    ok = ok && lcd_write(config, interface, LCD_RETURN_HOME, 0);
+    config->active_ctrl = LCD_CTRL_0;
+    // Return home shows page 0, drawing continues on the hidden page like after lcd_home()
+    config->front_page = 0;
+    config->draw_page = (config->page_offset > 0) ? 1 : 0;
+    return ok && wait_busy(config, interface);
+}
+
+void lcd_set_charset(lcd_config_s *config, lcd_charset_s *charset){
+    // Only four custom characters exist with 5x10 font
+    if (charset != NULL && config->font == LCD_FONT_5x10)
+        lcd_charset_limit(charset, LCD_CGRAM_SLOTS_5x10);
+    config->charset = charset;
 }
 
 /* High level commands for user */
 
 // Power switching
-void lcd_power_on(interface_s *interface){
+bool lcd_power_on(interface_s *interface){
     // Empty LCD command, no E pulse, only cathode
     lcd_cmd_s lcd_cmd;
     lcd_cmd.data = 0x00;
@@ -251,10 +699,11 @@ void lcd_power_on(interface_s *interface){
     lcd_cmd.rs = 0;
     lcd_cmd.rw = 0;
     lcd_cmd.e = 0;
-    interface->write_fun(interface->config, lcd_cmd);
+    lcd_cmd.e2 = 0;
+    return lcd_out(interface, lcd_cmd);
 }
 
-void lcd_power_off(interface_s *interface){
+bool lcd_power_off(interface_s *interface){
     // Empty LCD command, no E pulse, only cathode
     lcd_cmd_s lcd_cmd;
     lcd_cmd.data = 0x00;
@@ -262,202 +711,412 @@ void lcd_power_off(interface_s *interface){
     lcd_cmd.rs = 0;
     lcd_cmd.rw = 0;
     lcd_cmd.e = 0;
-    interface->write_fun(interface->config, lcd_cmd);
+    lcd_cmd.e2 = 0;
+    return lcd_out(interface, lcd_cmd);
 }
 
 // Display functions
-void lcd_display_on(lcd_config_s *config, interface_s *interface){
+bool lcd_display_on(lcd_config_s *config, interface_s *interface){
     // Update state
     config->state_display_control |= LCD_DISPLAY_ON;
     // Use state
-    lcd_write(config, interface, LCD_DISPLAY_CONTROL | config->state_display_control, 0);
+    return lcd_update_display_control(config, interface);
 }
 
-void lcd_display_off(lcd_config_s *config, interface_s *interface){
+bool lcd_display_off(lcd_config_s *config, interface_s *interface){
     // Update state
     config->state_display_control &= (~LCD_DISPLAY_ON);
     // Use state
-    lcd_write(config, interface, LCD_DISPLAY_CONTROL | config->state_display_control, 0);
+    return lcd_update_display_control(config, interface);
 }
 
-void lcd_blink_on(lcd_config_s *config, interface_s *interface){
+bool lcd_blink_on(lcd_config_s *config, interface_s *interface){
     // Update state
     config->state_display_control |= LCD_BLINK_ON;
     // Use state
-    lcd_write(config, interface, LCD_DISPLAY_CONTROL | config->state_display_control, 0);
+    return lcd_update_display_control(config, interface);
 }
 
-void lcd_blink_off(lcd_config_s *config, interface_s *interface){
+bool lcd_blink_off(lcd_config_s *config, interface_s *interface){
     // Update state
     config->state_display_control &= (~LCD_BLINK_ON);
     // Use state
-    lcd_write(config, interface, LCD_DISPLAY_CONTROL | config->state_display_control, 0);
+    return lcd_update_display_control(config, interface);
+}
+
+bool lcd_mv_right(lcd_config_s *config, interface_s *interface){
+    // The display shift selects the page while double buffering
+    if (config->page_offset > 0)
+        return false;
+    return lcd_write(config, interface, LCD_CURSOR_SHIFT | LCD_DISPLAYMOVE | LCD_MOVERIGHT, 0);
+}
+
+bool lcd_mv_left(lcd_config_s *config, interface_s *interface){
+    // The display shift selects the page while double buffering
+    if (config->page_offset > 0)
+        return false;
+    return lcd_write(config, interface, LCD_CURSOR_SHIFT | LCD_DISPLAYMOVE | LCD_MOVELEFT, 0);
+}
+
+// Double buffering
+int lcd_double_buffer(lcd_config_s *config, interface_s *interface, bool enable){
+    const lcd_geometry_s *geometry = &config->geometry;
+    uint8_t width = (geometry->split_col > 0) ? geometry->split_col : geometry->cols;
+    
+    if (!enable){
+        // Show page 0 again before the hidden columns become regular DDRAM
+        if (config->front_page != 0 && !lcd_page_flip(config, interface))
+            return -1;
+        config->page_offset = 0;
+        config->draw_page = 0;
+        return 0;
+    }
+    
+    // Hidden columns of every line have to hold a full page
+    if (!lcd_page_fits(geometry, width))
+        return -1;
+    
+    config->page_offset = width;
+    config->draw_page = config->front_page ^ 1;
+    return 0;
+}
+
+bool lcd_page_flip(lcd_config_s *config, interface_s *interface){
+    if (config->page_offset == 0)
+        return true;
+    
+    if (config->front_page == 0){
+        // The controller has no command to move the display by more than one cell
+        // Scroll the hidden page into view with back to back shifts, in bursts if the interface supports them
+        // Each shift executes while the next one is transferred
+        uint8_t shifts[MAX_COLS_SUPPORTED];
+        for (uint8_t i = 0; i < config->page_offset; i++)
+            shifts[i] = LCD_CURSOR_SHIFT | LCD_DISPLAYMOVE | LCD_MOVELEFT;
+        if (!lcd_stream(config, interface, shifts, config->page_offset, 0, lcd_ctrl_all(config)))
+            return false;
+        config->front_page = 1;
+    }
+    else{
+        // Return home resets the display shift with a single command
+        if (!lcd_write(config, interface, LCD_RETURN_HOME, 0) || !wait_busy(config, interface))
+            return false;
+        config->front_page = 0;
+    }
+    
+    // Continue drawing on the new back page
+    config->draw_page = config->front_page ^ 1;
+    return lcd_mv_cursor(config, interface, 0, 0);
 }
 
-void lcd_mv_right(const lcd_config_s *config, interface_s *interface){
-    lcd_write(config, interface, LCD_CURSOR_SHIFT | LCD_DISPLAYMOVE | LCD_MOVERIGHT, 0);
+void lcd_page_target(lcd_config_s *config, lcd_page_e page){
+    if (config->page_offset == 0)
+        return;
+    config->draw_page = (page == LCD_PAGE_FRONT) ? config->front_page : config->front_page ^ 1;
 }
 
-void lcd_mv_left(const lcd_config_s *config, interface_s *interface){
-    lcd_write(config, interface, LCD_CURSOR_SHIFT | LCD_DISPLAYMOVE | LCD_MOVELEFT, 0);
+uint8_t lcd_page_front(const lcd_config_s *config){
+    return config->front_page;
 }
 
 // Cursor functions
-void lcd_cursor_on(lcd_config_s *config, interface_s *interface){
+bool lcd_cursor_on(lcd_config_s *config, interface_s *interface){
     // Update state
     config->state_display_control |= LCD_CURSOR_ON;
     // Use state
-    lcd_write(config, interface, LCD_DISPLAY_CONTROL | config->state_display_control, 0);
+    return lcd_update_display_control(config, interface);
 }
 
-void lcd_cursor_off(lcd_config_s *config, interface_s *interface){
+bool lcd_cursor_off(lcd_config_s *config, interface_s *interface){
     // Update state
     config->state_display_control &= (~LCD_CURSOR_ON);
     // Use state
-    lcd_write(config, interface, LCD_DISPLAY_CONTROL | config->state_display_control, 0);
+    return lcd_update_display_control(config, interface);
 }
 
-void lcd_mv_cursor_right(const lcd_config_s *config, interface_s *interface){
-    lcd_write(config, interface, LCD_CURSOR_SHIFT | LCD_MOVERIGHT, 0);
+bool lcd_mv_cursor_right(lcd_config_s *config, interface_s *interface){
+    return lcd_write_ctrl(config, interface, LCD_CURSOR_SHIFT | LCD_MOVERIGHT, 0, config->active_ctrl);
 }
 
-void lcd_mv_cursor_left(const lcd_config_s *config, interface_s *interface){
-    lcd_write(config, interface, LCD_CURSOR_SHIFT | LCD_MOVELEFT, 0);
+bool lcd_mv_cursor_left(lcd_config_s *config, interface_s *interface){
+    return lcd_write_ctrl(config, interface, LCD_CURSOR_SHIFT | LCD_MOVELEFT, 0, config->active_ctrl);
 }
 
-void lcd_mv_cursor(const lcd_config_s *config, interface_s *interface, uint8_t row, uint8_t col){
+bool lcd_mv_cursor(lcd_config_s *config, interface_s *interface, uint8_t row, uint8_t col){
     // No write possible if target is outside of specified LCD area
     if (col >= config->cols || row >= config->rows)
-        return;
+        return false;
     
     // Calculate target address (7-bit, 8th bit is always set to indicate command)
-    uint8_t addr = LCD_SET_DDRAM_ADDR;
+    // Line start addresses are taken from the geometry since they are not continuous in memory
+    uint8_t addr = LCD_SET_DDRAM_ADDR | lcd_page_addr(config, row, col);
+    uint8_t ctrl = config->geometry.line_ctrl[row];
     
-    // Switch for line start addresses since they are not continuous in memory
-    switch(row){
-        case 0:
-            addr |= (LCD_LINE0_ADDR + col);
-            break;
-        case 1:
-            addr |= (LCD_LINE1_ADDR + col);
-            break;
-        case 2:
-            addr |= (LCD_LINE2_ADDR + col);
-            break;
-        case 3:
-            addr |= (LCD_LINE3_ADDR + col);
-            break;
-        default:
-            return;
-    }
+    // Cursor and blink follow the controller of the row
+    if (!lcd_select_ctrl(config, interface, ctrl))
+        return false;
     
     // Set display address
-    lcd_write(config, interface, addr, 0);
+    return lcd_write_ctrl(config, interface, addr, 0, ctrl);
 }
 
-lcd_pos_s lcd_get_cursor(const lcd_config_s *config, interface_s *interface){
-    lcd_pos_s curr_pos;
+lcd_pos_s lcd_get_cursor(lcd_config_s *config, interface_s *interface){
+    const lcd_geometry_s *geometry = &config->geometry;
+    uint8_t pages = (config->page_offset > 0) ? 2 : 1;
+    lcd_pos_s curr_pos = {0, 0};
+    uint8_t base = 0;
     
-    // Get value of address counter
-    lcd_status_s lcd_status = lcd_get_status(config, interface);
+    // Get value of address counter, the shadow holds it if the bus failed
+    lcd_status_s lcd_status;
+    if (!lcd_read_status(config, interface, config->active_ctrl, &lcd_status))
+        lcd_status.address = config->shadow_addr[(config->active_ctrl == LCD_CTRL_1) ? 1 : 0] & 0x7f;
     
     // Derive rows and columns from address
-    switch(config->rows){
-        case 2:
-            curr_pos.row = lcd_status.address >= LCD_LINE1_ADDR;
-            curr_pos.col = lcd_status.address - curr_pos.row * LCD_LINE1_ADDR;
-            break;
-        case 3:
-            // Intentional fall-through
-        case 4:
-            if (config->rows > 3 && lcd_status.address >= LCD_LINE3_ADDR){
-                curr_pos.row = 3;
-                curr_pos.col = lcd_status.address - LCD_LINE3_ADDR;
-            }
-            else if (lcd_status.address >= LCD_LINE2_ADDR){
-                curr_pos.row = 2;
-                curr_pos.col = lcd_status.address - LCD_LINE2_ADDR;
-            }
-            else if (lcd_status.address >= LCD_LINE1_ADDR){
-                curr_pos.row = 1;
-                curr_pos.col = lcd_status.address - LCD_LINE1_ADDR;
+    // Use the closest segment start below the address among the rows of the active controller on both pages
+    for (uint8_t page = 0; page < pages; page++){
+        uint8_t offset = page * config->page_offset;
+        
+        for (uint8_t row = 0; row < geometry->rows; row++){
+            if (geometry->line_ctrl[row] != config->active_ctrl)
+                continue;
+
+            if (lcd_status.address >= geometry->line_addr[row] + offset && geometry->line_addr[row] + offset >= base){
+                base = geometry->line_addr[row] + offset;
+                curr_pos.row = row;
+                curr_pos.col = lcd_status.address - base;
             }
-            else{
-                curr_pos.row = 0;
-                curr_pos.col = lcd_status.address;
+            if (geometry->split_col > 0 && lcd_status.address >= geometry->split_addr[row] + offset && geometry->split_addr[row] + offset >= base){
+                base = geometry->split_addr[row] + offset;
+                curr_pos.row = row;
+                curr_pos.col = geometry->split_col + (lcd_status.address - base);
             }
-            break;
-        case 1:
-            // Intentional fall-through
-        default:
-            // Row is always one
-            curr_pos.row = 0;
-            curr_pos.col = lcd_status.address;
-    }    
+        }
+    }
     return curr_pos;
 }
 
 // Print functions
-void lcd_putc(const lcd_config_s *config, interface_s *interface, char c){
-    lcd_write(config, interface, (uint8_t) c, 1);
-}
-
-void lcd_printf(const lcd_config_s *config, interface_s *interface, char *s){
-    // Maximum string length is rows * columns of the display
-    uint16_t size = config->rows * config->cols;
-    lcd_pos_s init_pos = lcd_get_cursor(config, interface);
-    uint8_t counter = 0;
-    
-    // Print characters one by one
-    // Stop after rows*cols characters or at null terminator
-    for(char *c = s; *c != '\0' && counter < size; c++, counter++){        
-        // Wrap cursor to next line
-        if (config->mode == LCD_MODE_WRAP && (init_pos.col + counter) >= config->cols){
-            // Stop if last row is reached, no further wrap possible
-            init_pos.row++;
-            if (init_pos.row >= config->rows)
-                return;
+// Write a fallback glyph to CGRAM
+static bool lcd_upload_glyph(lcd_config_s *config, interface_s *interface, uint8_t slot, const lcd_glyph_s *glyph){
+    uint8_t rows = (config->font == LCD_FONT_5x10) ? 10 : 8;
+    uint8_t stride = (config->font == LCD_FONT_5x10) ? 16 : 8;
+    
+    // Only four characters possible with 5x10 font, lcd_set_charset() limits the slots accordingly
+    if (slot * stride >= 64)
+        return false;
+    return lcd_patch_cgram(config, interface, slot * stride, glyph->bitmap, rows);
+}
+
+// Translate a printed line to character codes, false if a glyph upload failed
+static bool lcd_translate_line(lcd_config_s *config, interface_s *interface, const char *s, uint8_t *codes, uint8_t max_len, uint8_t *len){
+    int code;
+    
+    *len = 0;
+    for (; *s != '\0' && *len < max_len; s++){
+        code = lcd_translate(config, interface, (uint8_t) *s);
+        if (code == LCD_CODE_ERROR)
+            return false;
+        if (code >= 0)
+            codes[(*len)++] = (uint8_t) code;
+    }
+    return true;
+}
+
+int lcd_translate(lcd_config_s *config, interface_s *interface, uint8_t byte){
+    lcd_charset_s *charset = config->charset;
+    const lcd_glyph_s *glyph;
+    uint32_t code_point;
+    uint8_t code;
+    int slot;
+    
+    // Raw bytes without transcoder
+    if (charset == NULL)
+        return byte;
+    
+    // Wait for complete code point
+    if (!lcd_utf8_decode(charset, byte, &code_point))
+        return LCD_CODE_PENDING;
+    
+    // Glyph from character ROM
+    if (lcd_charset_rom(charset->rom, code_point, &code))
+        return code;
+    
+    // Glyph from CGRAM, uploaded on first use
+    slot = lcd_charset_slot(charset, code_point, &glyph);
+    if (slot < 0)
+        return LCD_CHARSET_REPLACEMENT;
+    if (glyph != NULL && !lcd_upload_glyph(config, interface, (uint8_t) slot, glyph)){
+        // CGRAM content of the slot is unknown, free it so the next use uploads again
+        charset->slot_cp[slot] = 0;
+        return LCD_CODE_ERROR;
+    }
+    return slot;
+}
+
+bool lcd_put_code(lcd_config_s *config, interface_s *interface, uint8_t code){
+    return lcd_write_ctrl(config, interface, code, 1, config->active_ctrl);
+}
+
+bool lcd_putc(lcd_config_s *config, interface_s *interface, char c){
+    int code = lcd_translate(config, interface, (uint8_t) c);
+    
+    if (code == LCD_CODE_ERROR)
+        return false;
+    // Nothing to print until a multi-byte character is complete
+    if (code >= 0)
+        return lcd_put_code(config, interface, (uint8_t) code);
+    return true;
+}
+
+bool lcd_printf(lcd_config_s *config, interface_s *interface, char *s){
+    lcd_pos_s pos = lcd_get_cursor(config, interface);
+    uint8_t codes[MAX_COLS_SUPPORTED];
+    uint8_t len;
+    int code;
+    
+    // Print row by row, stop at the end of the display or at null terminator
+    while (*s != '\0'){
+        if (pos.col >= config->cols){
+            // Stop if wrapping is disabled or last row is reached, no further wrap possible
+            if (config->mode != LCD_MODE_WRAP || pos.row + 1 >= config->rows)
+                return true;
             
-            // Reset counter for next row and go to start of next row
-            counter = 0;
-            lcd_mv_cursor(config, interface, init_pos.row, 0);
+            // Go to start of next row
+            pos.row++;
+            pos.col = 0;
+        }
+        
+        // Translate the part fitting into the current row, multi-byte characters occupy a single cell
+        // Glyph uploads happen here, before the address of the row is set
+        for (len = 0; *s != '\0' && pos.col + len < config->cols; s++){
+            code = lcd_translate(config, interface, (uint8_t) *s);
+            if (code == LCD_CODE_ERROR)
+                return false;
+            if (code >= 0)
+                codes[len++] = (uint8_t) code;
+        }
+        
+        if (!lcd_write_buffer(config, interface, pos.row, pos.col, codes, len))
+            return false;
+        pos.col += len;
+    }
+    return true;
+}
+
+bool lcd_printf_at(lcd_config_s *config, interface_s *interface, char *s, uint8_t row, uint8_t col){
+    return lcd_mv_cursor(config, interface, row, col) && lcd_printf(config, interface, s);
+}
+
+bool lcd_print_rows(lcd_config_s *config, interface_s *interface, char * const *lines, uint8_t first_row, uint8_t count){
+    const lcd_geometry_s *geometry = &config->geometry;
+    uint8_t end = (first_row + count < config->rows) ? first_row + count : config->rows;
+    uint8_t next[MAX_CTRL_SUPPORTED] = {first_row, first_row};
+    uint8_t cursor_ctrl = config->active_ctrl;
+    
+    // Rows are written in pairs of one row per controller
+    // Every byte sent to one controller executes while the other one is written
+    while (1){
+        uint8_t codes[MAX_CTRL_SUPPORTED][MAX_COLS_SUPPORTED];
+        uint8_t len[MAX_CTRL_SUPPORTED] = {0, 0};
+        uint8_t row[MAX_CTRL_SUPPORTED] = {0, 0};
+        uint8_t pending = 0;
+        
+        // Pick next row of each controller and translate it before the bus is busy
+        for (uint8_t i = 0; i < geometry->controllers; i++){
+            while (next[i] < end && geometry->line_ctrl[next[i]] != (LCD_CTRL_0 << i))
+                next[i]++;
+            if (next[i] < end){
+                row[i] = next[i]++;
+                if (!lcd_translate_line(config, interface, lines[row[i] - first_row], codes[i], config->cols, &len[i]))
+                    return false;
+                pending |= (LCD_CTRL_0 << i);
+            }
         }
+        // Cursor stays behind the last character written, on the controller that got it
+        if (!pending)
+            return lcd_select_ctrl(config, interface, cursor_ctrl);
         
-        // Print next character at current cursor position
-        // Cursor is automatically incremented
-        lcd_putc(config, interface, *c);
+        for (uint8_t col = 0; pending; col++){
+            // Set address at start of every row segment, one execution delay after the last controller covers both
+            if (col == 0 || (geometry->split_col > 0 && col == geometry->split_col)){
+                uint8_t last = (pending & LCD_CTRL_1) ? 1 : 0;
+                for (uint8_t i = 0; i <= last; i++){
+                    if ((pending & (LCD_CTRL_0 << i)) &&
+                        !lcd_send(config, interface, LCD_SET_DDRAM_ADDR | lcd_page_addr(config, row[i], col), 0, LCD_CTRL_0 << i,
+                                  (i == last) ? CMD_DELAY_US : 0))
+                        return false;
+                }
+            }
+            
+            // Rows that are complete
+            for (uint8_t i = 0; i < MAX_CTRL_SUPPORTED; i++){
+                if ((pending & (LCD_CTRL_0 << i)) && col >= len[i])
+                    pending &= ~(LCD_CTRL_0 << i);
+            }
+            
+            // Send next character of each row, one execution delay covers both
+            uint8_t last = (pending & LCD_CTRL_1) ? 1 : 0;
+            for (uint8_t i = 0; i <= last; i++){
+                if (!(pending & (LCD_CTRL_0 << i)))
+                    continue;
+                if (!lcd_send(config, interface, codes[i][col], 1, LCD_CTRL_0 << i, (i == last) ? CMD_DELAY_US : 0))
+                    return false;
+                cursor_ctrl = LCD_CTRL_0 << i;
+            }
+        }
     }
 }
 
-void lcd_printf_at(const lcd_config_s *config, interface_s *interface, char *s, uint8_t row, uint8_t col){
-    lcd_mv_cursor(config, interface, row, col);
-    lcd_printf(config, interface, s);
+bool lcd_write_buffer(lcd_config_s *config, interface_s *interface, uint8_t row, uint8_t col, const uint8_t *buf, uint16_t len){
+    uint8_t split = config->geometry.split_col;
+    uint8_t end;
+    uint16_t n;
+    
+    while (len > 0 && row < config->rows){
+        // Continue at start of next row
+        if (col >= config->cols){
+            row++;
+            col = 0;
+            continue;
+        }
+        
+        // Cells up to the end of the row segment are continuous in memory
+        end = (split > 0 && col < split) ? split : config->cols;
+        n = (len < (uint16_t) (end - col)) ? len : end - col;
+        
+        if (!lcd_mv_cursor(config, interface, row, col) || !lcd_stream(config, interface, buf, n, 1, config->active_ctrl))
+            return false;
+        buf += n;
+        len -= n;
+        col += n;
+    }
+    return true;
 }
 
-char lcd_getc(const lcd_config_s *config, interface_s *interface){
-    return (char) lcd_read(config, interface, 1);
+char lcd_getc(lcd_config_s *config, interface_s *interface){
+    uint8_t value = 0;
+    
+    // Reading data increments the address counter like writing
+    if (lcd_read(config, interface, 1, config->active_ctrl, &value))
+        lcd_shadow_update(config, value, 1, config->active_ctrl);
+    return (char) value;
 }
 
 // LCD Status
-lcd_status_s lcd_get_status(const lcd_config_s *config, interface_s *interface){
-    uint8_t temp;
-    lcd_status_s status;
-    temp = lcd_read(config, interface, 0);
-    status.address = temp & ~(1 << 7);
-    status.busy = temp & (1 << 7);
-    return status;    
+bool lcd_get_status(lcd_config_s *config, interface_s *interface, lcd_status_s *status){
+    // Status of the controller holding the cursor
+    return lcd_read_status(config, interface, config->active_ctrl, status);
 }
 
 // Special characters
-void lcd_create_custom(const lcd_config_s *config, interface_s *interface, uint8_t addr, uint8_t *character){
-    int max_row;
+bool lcd_create_custom(lcd_config_s *config, interface_s *interface, uint8_t addr, const uint8_t *character){
+    uint8_t max_row;
        
     // Get number of rows to write to CGRAM
     switch (config->font){
         case LCD_FONT_5x10:
             // Only four characters possible
             if (addr >= 0x04)
-                return;
+                return false;
             addr <<= 4;
             max_row = 10;
             break;
@@ -466,17 +1125,39 @@ void lcd_create_custom(const lcd_config_s *config, interface_s *interface, uint8
         default:
             // Only eight characters possible
             if (addr >= 0x08)
-                return;
+                return false;
             addr <<= 3;
             max_row = 8;
     }
     
+    return lcd_write_cgram(config, interface, addr, character, max_row);
+}
+
+bool lcd_patch_cgram(lcd_config_s *config, interface_s *interface, uint8_t addr, const uint8_t *buf, uint8_t len){
+    uint8_t ctrl_all = lcd_ctrl_all(config);
+    uint8_t saved[MAX_CTRL_SUPPORTED];
+    
+    // Address counter of every controller before the upload
+    for (uint8_t i = 0; (LCD_CTRL_0 << i) & ctrl_all; i++)
+        saved[i] = config->shadow_addr[i];
+    
+    if (!lcd_write_cgram(config, interface, addr, buf, len))
+        return false;
+    
+    // Return to the saved addresses
+    for (uint8_t i = 0; (LCD_CTRL_0 << i) & ctrl_all; i++){
+        uint8_t cmd = (saved[i] & LCD_SHADOW_CGRAM) ? LCD_SET_CGRAM_ADDR | (saved[i] & 0x3f) : LCD_SET_DDRAM_ADDR | saved[i];
+        if (!lcd_write_ctrl(config, interface, cmd, 0, LCD_CTRL_0 << i))
+            return false;
+    }
+    return true;
+}
+
+bool lcd_write_cgram(lcd_config_s *config, interface_s *interface, uint8_t addr, const uint8_t *buf, uint8_t len){
     // Set initial CGRAM address
-    lcd_write(config, interface, LCD_SET_CGRAM_ADDR | addr, 0);
+    if (!lcd_write(config, interface, LCD_SET_CGRAM_ADDR | (addr & 0x3f), 0))
+        return false;
     
-    // Write data to CGRAM address
     // CGRAM address is incremented automatically
-    for (int row=0; row < max_row; row++, character++){
-        lcd_write(config, interface, *character, 1);
-    }
+    return lcd_stream(config, interface, buf, len, 1, lcd_ctrl_all(config));
 }
@@ -15,14 +15,23 @@ extern "C" {
 // ASCII Characters 33..125 are represented by their 8-bit int value
   
 #include <stdint.h>
+#include <stdbool.h>
+#include "lcd_charset.h"
    
 #define BOOT_DELAY_US           50000
 #define LEVEL_DELAY_US          20
 #define CMD_DELAY_US            10000
 #define DATA_HOLD_DELAY_US      500
 #define DATA_OUTPUT_DELAY_US    500
+#define RESYNC_DELAY_US         2000        // Longest instruction (return home) while resynchronising a running controller
+#define EXEC_DELAY_US           41          // Execution of a data write or shift (37 us + 4 us at 270 kHz), covered by bus time in bursts
 
+#define LCD_IO_RETRIES          3           // Attempts per bus transfer before the controllers are resynchronised
+#define LCD_RESYNC_ATTEMPTS     2           // Resynchronisations per byte before an error is returned
+
+// Printing stops at the end of the row (older versions streamed up to rows*cols bytes into DDRAM behind the row)
 #define LCD_MODE_TRUNCATE       0x00
+// Printing continues at the start of the next row and stops at the end of the display
 #define LCD_MODE_WRAP           0x01
     
 // Line addresses
@@ -70,11 +79,39 @@ extern "C" {
 #define LCD_5F10                0x04        // Flag to set 5x10 character font
     
 #define MAX_ROWS_SUPPORTED      4
+#define MAX_CTRL_SUPPORTED      2
+#define MAX_COLS_SUPPORTED      40
+#define LCD_BURST_BYTES         8           // Data bytes per burst transfer of the interface
+#define LCD_SHADOW_CGRAM        0x80        // Shadow address points to CGRAM
+#define LCD_CODE_PENDING        (-1)        // lcd_translate(): code point incomplete, nothing to print
+#define LCD_CODE_ERROR          (-2)        // lcd_translate(): glyph upload to CGRAM failed
+    
+// Controller selection masks (one enable line per controller)
+#define LCD_CTRL_0              0x01
+#define LCD_CTRL_1              0x02
+#define LCD_CTRL_ALL            (LCD_CTRL_0 | LCD_CTRL_1)
     
 // Enumerator for 4-bit or 8-bit data bus
 typedef enum {LCD_BUS_WIDTH_8, LCD_BUS_WIDTH_4} lcd_bit_e;
 // Enumerator for font size
 typedef enum {LCD_FONT_5x8, LCD_FONT_5x10} lcd_font_e;
+// Enumerator for the page addressed by cursor functions in double buffer mode
+typedef enum {LCD_PAGE_FRONT, LCD_PAGE_BACK} lcd_page_e;
+// Enumerator for the known panel layouts of lcd_geometry_table
+typedef enum {
+    LCD_GEOMETRY_8x1,
+    LCD_GEOMETRY_16x1,          // Linear addressing (one line of 16 cells)
+    LCD_GEOMETRY_16x1_SPLIT,    // Addressed as 8x2, right half starts at line 1
+    LCD_GEOMETRY_8x2,
+    LCD_GEOMETRY_16x2,
+    LCD_GEOMETRY_20x2,
+    LCD_GEOMETRY_24x2,
+    LCD_GEOMETRY_40x2,
+    LCD_GEOMETRY_16x4,
+    LCD_GEOMETRY_20x4,
+    LCD_GEOMETRY_40x4,          // Two controllers with separate enable lines
+    LCD_GEOMETRY_COUNT
+} lcd_geometry_e;
   
 // Structure for commanded 8-bit data lines, 4-bit control lines
 typedef struct{
@@ -83,6 +120,7 @@ typedef struct{
     uint8_t rs;    // Data signal (1), instruction signal(0)
     uint8_t e;     // Clock latch
     uint8_t ledk;  // LED Back light cathode
+    uint8_t e2;    // Clock latch of the second controller (dual-controller panels only)
 }lcd_cmd_s;
     
 typedef struct{
@@ -95,6 +133,22 @@ typedef struct{
     uint8_t col;
 }lcd_pos_s;
 
+// Description of the DDRAM layout of a panel
+// A row may be split into two address segments (e.g. 16x1 panels addressed as 8x2)
+typedef struct{
+    uint8_t rows;                               // Number of visible rows
+    uint8_t cols;                               // Number of visible columns
+    uint8_t ctrl_lines;                         // Lines per controller (N bit of function set)
+    uint8_t controllers;                        // Number of controllers (enable lines)
+    uint8_t split_col;                          // First column of the second segment, 0 if rows are not split
+    uint8_t line_addr[MAX_ROWS_SUPPORTED];      // DDRAM address of column 0 of each row
+    uint8_t split_addr[MAX_ROWS_SUPPORTED];     // DDRAM address of column split_col of each row
+    uint8_t line_ctrl[MAX_ROWS_SUPPORTED];      // Controller mask driving each row
+}lcd_geometry_s;
+
+// Table of known panel layouts, indexed by lcd_geometry_e
+extern const lcd_geometry_s lcd_geometry_table[LCD_GEOMETRY_COUNT];
+
 // Structure for an LCD configuration
 typedef struct{
     lcd_bit_e bus_width;    // Configured bus width
@@ -103,60 +157,116 @@ typedef struct{
     uint8_t cols;    // Number of columns
     uint8_t state_display_control;
     uint8_t mode;
+    lcd_geometry_s geometry;    // DDRAM layout of the panel
+    uint8_t active_ctrl;        // Controller holding the cursor
+    lcd_charset_s *charset;     // UTF-8 transcoder for printed text, NULL sends raw bytes
+    uint8_t page_offset;        // Address offset of the hidden page, 0 without double buffering
+    uint8_t front_page;         // Page currently shown (0 or 1)
+    uint8_t draw_page;          // Page addressed by cursor functions (0 or 1)
+    uint8_t shadow_addr[MAX_CTRL_SUPPORTED];    // Address counter of each controller after the last acknowledged byte
+    uint8_t shadow_shift;       // Display shift to the left after the last acknowledged byte
+    bool resync_pending;        // Recovery gave up, controllers are resynchronised before the next transfer
 }lcd_config_s;
 
 // Function pointer to write callback
 typedef bool (*IF_Write_Fcn)(void *interface_config, lcd_cmd_s lcd_cmd);
-typedef uint8_t (*IF_Read_Fcn)(void *interface_config);
+// Function pointer to read callback, false if the transfer failed
+typedef bool (*IF_Read_Fcn)(void *interface_config, uint8_t *data);
+// Function pointer to write a sequence of commands in one bus transfer
+typedef bool (*IF_Write_Burst_Fcn)(void *interface_config, const lcd_cmd_s *lcd_cmds, uint16_t count);
 
 typedef struct{
     void *config;           // Generic pointer to configuration used by the interface
     IF_Write_Fcn write_fun; // Function pointer to write callback function of interface     
     IF_Read_Fcn read_fun;   // Function pointer to read callback function of interface
+    IF_Write_Burst_Fcn write_burst_fun;  // Optional burst write callback, NULL writes every command on its own
+    uint16_t burst_edge_us;     // Minimum time between two commands of a burst, bursts are not used while 0
+    // Minimum time from a write call until the outputs change, subtracted from delays before writes
+    // Must be 0 or a guaranteed lower bound of the interface (e.g. pcf8574_lcd_if_latency_us()), larger values shorten required delays
+    uint16_t min_latency_us;
 }interface_s;
 
+// Set up the interface, the optional fields are cleared and may be set afterwards
+// Without this function, the whole structure has to be zero-initialized before use
+void lcd_interface_init(interface_s *interface, void *interface_config, IF_Write_Fcn write_fun, IF_Read_Fcn read_fun);
+
 // Initialize the LCD
 int lcd_configure(lcd_config_s *config, lcd_bit_e bus_width, lcd_font_e font, uint8_t rows, uint8_t cols, uint8_t mode);
-void lcd_init(lcd_config_s *config, interface_s * interface);
+int lcd_configure_geometry(lcd_config_s *config, lcd_bit_e bus_width, lcd_font_e font, const lcd_geometry_s *geometry, uint8_t mode);
+bool lcd_init(lcd_config_s *config, interface_s * interface);
+// Decode printed text as UTF-8 and translate it to the character ROM
+// With 5x10 font the reserved fallback slots are limited to the four CGRAM characters
+void lcd_set_charset(lcd_config_s *config, lcd_charset_s *charset);
 
 /* High level functions for user */
+// Functions returning bool are false if the bus failed after all retries and resynchronisations
+// The configuration is not const for functions that access the bus: it tracks the controller holding
+// the cursor (dual-controller panels), the page state and the address shadow used for resynchronisation
 
-void wait_busy(const lcd_config_s *config, interface_s *interface);
-void lcd_clear(const lcd_config_s *config, interface_s *interface);
-void lcd_home(const lcd_config_s *config, interface_s *interface);
+bool wait_busy(lcd_config_s *config, interface_s *interface);
+bool lcd_clear(lcd_config_s *config, interface_s *interface);
+bool lcd_home(lcd_config_s *config, interface_s *interface);
 
-// Power
-void lcd_power_on(interface_s *interface);
-void lcd_power_off(interface_s *interface);
+// Power (back light cathode LEDK)
+// Without effect on dual-controller panels behind a PCF8574, LEDK_PIN is the second enable line there
+bool lcd_power_on(interface_s *interface);
+bool lcd_power_off(interface_s *interface);
 
 // Display
-void lcd_display_on(lcd_config_s *config, interface_s *interface);
-void lcd_display_off(lcd_config_s *config, interface_s *interface);
-void lcd_blink_on(lcd_config_s *config, interface_s *interface);
-void lcd_blink_off(lcd_config_s *config, interface_s *interface);
+bool lcd_display_on(lcd_config_s *config, interface_s *interface);
+bool lcd_display_off(lcd_config_s *config, interface_s *interface);
+bool lcd_blink_on(lcd_config_s *config, interface_s *interface);
+bool lcd_blink_off(lcd_config_s *config, interface_s *interface);
 
 /* DDRAM Addresses are moved when whole display is moved */
-void lcd_mv_right(const lcd_config_s *config, interface_s *interface);
-void lcd_mv_left(const lcd_config_s *config, interface_s *interface);
+// False while double buffering is enabled, the display shift selects the page then
+bool lcd_mv_right(lcd_config_s *config, interface_s *interface);
+bool lcd_mv_left(lcd_config_s *config, interface_s *interface);
+
+/* Double buffering: the back page is drawn in hidden DDRAM columns and shown by a display shift */
+// Enable or disable double buffering, -1 if the hidden columns of the geometry cannot hold a page or the bus failed
+int lcd_double_buffer(lcd_config_s *config, interface_s *interface, bool enable);
+// Show the back page, cursor moves to row 0, column 0 of the new back page
+// Page 0 returns at once (return home), page 1 scrolls in by page width single-cell shifts sent back to back
+// (one burst transfer per LCD_BURST_BYTES shifts if available, e.g. 16 shifts in about 6 ms at 100 kHz)
+bool lcd_page_flip(lcd_config_s *config, interface_s *interface);
+// Select the page addressed by cursor and print functions, back page is selected after enabling and flipping
+void lcd_page_target(lcd_config_s *config, lcd_page_e page);
+// Index of the page currently shown
+uint8_t lcd_page_front(const lcd_config_s *config);
 
 // Cursor
-void lcd_cursor_on(lcd_config_s *config, interface_s *interface);
-void lcd_cursor_off(lcd_config_s *config, interface_s *interface);
-void lcd_mv_cursor_right(const lcd_config_s *config, interface_s *interface);
-void lcd_mv_cursor_left(const lcd_config_s *config, interface_s *interface);
-void lcd_mv_cursor(const lcd_config_s *config, interface_s *interface, uint8_t row, uint8_t col);
-lcd_pos_s lcd_get_cursor(const lcd_config_s *config, interface_s *interface);
+bool lcd_cursor_on(lcd_config_s *config, interface_s *interface);
+bool lcd_cursor_off(lcd_config_s *config, interface_s *interface);
+bool lcd_mv_cursor_right(lcd_config_s *config, interface_s *interface);
+bool lcd_mv_cursor_left(lcd_config_s *config, interface_s *interface);
+bool lcd_mv_cursor(lcd_config_s *config, interface_s *interface, uint8_t row, uint8_t col);
+lcd_pos_s lcd_get_cursor(lcd_config_s *config, interface_s *interface);
 
 // Print functions
-void lcd_putc(const lcd_config_s *config, interface_s *interface, char c);
-void lcd_printf(const lcd_config_s *config, interface_s *interface, char *s);
-void lcd_printf_at(const lcd_config_s *config, interface_s *interface, char *s, uint8_t row, uint8_t col);
-char lcd_getc(const lcd_config_s *config, interface_s *interface);
+// Translate a byte of printed text to a character code
+// LCD_CODE_PENDING while a code point is incomplete, LCD_CODE_ERROR if the glyph upload to CGRAM failed
+int lcd_translate(lcd_config_s *config, interface_s *interface, uint8_t byte);
+// Write a character code at the cursor without translation
+bool lcd_put_code(lcd_config_s *config, interface_s *interface, uint8_t code);
+bool lcd_putc(lcd_config_s *config, interface_s *interface, char c);
+bool lcd_printf(lcd_config_s *config, interface_s *interface, char *s);
+bool lcd_printf_at(lcd_config_s *config, interface_s *interface, char *s, uint8_t row, uint8_t col);
+// Print one line per row starting at column 0, rows of different controllers are written interleaved
+bool lcd_print_rows(lcd_config_s *config, interface_s *interface, char * const *lines, uint8_t first_row, uint8_t count);
+// Write character codes from row, col on, continues in the next rows and stops at the end of the display
+// The address is only set at the start of every row segment, the bytes in between are streamed
+bool lcd_write_buffer(lcd_config_s *config, interface_s *interface, uint8_t row, uint8_t col, const uint8_t *buf, uint16_t len);
+char lcd_getc(lcd_config_s *config, interface_s *interface);
 
-// LCD status
-lcd_status_s lcd_get_status(const lcd_config_s *config, interface_s *interface);
+// LCD status of the controller holding the cursor, false if the bus failed
+bool lcd_get_status(lcd_config_s *config, interface_s *interface, lcd_status_s *status);
 
-void lcd_create_custom(const lcd_config_s *config, interface_s *interface, uint8_t addr, uint8_t *character);
+bool lcd_create_custom(lcd_config_s *config, interface_s *interface, uint8_t addr, const uint8_t *character);
+// Stream bytes to CGRAM of all controllers from addr on, the address counter is left in CGRAM
+bool lcd_write_cgram(lcd_config_s *config, interface_s *interface, uint8_t addr, const uint8_t *buf, uint8_t len);
+// Same as lcd_write_cgram, every controller returns to its previous address afterwards
+bool lcd_patch_cgram(lcd_config_s *config, interface_s *interface, uint8_t addr, const uint8_t *buf, uint8_t len);
 
 #ifdef	__cplusplus
 }
@@ -0,0 +1,84 @@
+#include <stdint.h>
+#include <stddef.h>
+#include "lcd_anim.h"
+
+void lcd_anim_init(lcd_anim_s *anim, const lcd_config_s *config){
+    // Slot addresses are 8 apart in 5x8 font and 16 apart in 5x10 font
+    anim->rows = (config->font == LCD_FONT_5x10) ? 10 : 8;
+    anim->stride = (config->font == LCD_FONT_5x10) ? 16 : 8;
+    anim->slot_count = 64 / anim->stride;
+    
+    for (uint8_t i = 0; i < LCD_ANIM_SLOTS; i++){
+        anim->slots[i].frames = NULL;
+        anim->slots[i].active = false;
+        anim->slots[i].loaded = false;
+    }
+}
+
+int lcd_anim_start(lcd_anim_s *anim, uint8_t slot, const uint8_t *frames, uint8_t frame_count, uint32_t period, uint32_t now){
+    if (slot >= anim->slot_count || frames == NULL || frame_count == 0)
+        return -1;
+    
+    lcd_anim_slot_s *s = &anim->slots[slot];
+    
+    // A new sequence may share no rows with the bitmap in CGRAM
+    if (s->frames != frames)
+        s->loaded = false;
+    s->frames = frames;
+    s->frame_count = frame_count;
+    s->next = 0;
+    s->period = period;
+    s->due = now;
+    s->active = true;
+    return 0;
+}
+
+void lcd_anim_stop(lcd_anim_s *anim, uint8_t slot){
+    if (slot < anim->slot_count)
+        anim->slots[slot].active = false;
+}
+
+int lcd_anim_tick(lcd_anim_s *anim, lcd_config_s *config, interface_s *interface, uint32_t now){
+    lcd_anim_slot_s *s;
+    int slot = -1;
+    uint32_t late = 0;
+    
+    // Pick the slot waiting longest, one upload per tick bounds the time of a call
+    for (uint8_t i = 0; i < anim->slot_count; i++){
+        s = &anim->slots[i];
+        if (s->active && (int32_t) (now - s->due) >= 0 && (slot < 0 || now - s->due > late)){
+            slot = i;
+            late = now - s->due;
+        }
+    }
+    if (slot < 0)
+        return -1;
+    
+    s = &anim->slots[slot];
+    const uint8_t *cur = &s->frames[s->frame * anim->rows];
+    const uint8_t *bitmap = &s->frames[s->next * anim->rows];
+    uint8_t first = 0;
+    uint8_t last = anim->rows - 1;
+    
+    // Only the span of rows differing from the bitmap in CGRAM is uploaded
+    if (s->loaded){
+        while (first < anim->rows && bitmap[first] == cur[first])
+            first++;
+        while (last > first && bitmap[last] == cur[last])
+            last--;
+    }
+    if (first < anim->rows && !lcd_patch_cgram(config, interface, slot * anim->stride + first, &bitmap[first], last - first + 1)){
+        // CGRAM content is unknown, the whole frame is uploaded by the next tick
+        s->loaded = false;
+        return -1;
+    }
+    
+    s->frame = s->next;
+    s->next = (s->next + 1) % s->frame_count;
+    s->loaded = true;
+    // Keep the frame rate, skip frames missed by more than a period
+    s->due += s->period;
+    if ((int32_t) (now - s->due) >= 0)
+        s->due = now + s->period;
+    return slot;
+}
@@ -0,0 +1,56 @@
+#ifndef LCD_ANIM_H
+#define	LCD_ANIM_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lcd.h"
+    
+#define LCD_ANIM_SLOTS          8       // CGRAM slots in 5x8 font, 4 are usable in 5x10 font
+
+// Frame sequence shown by one CGRAM slot
+typedef struct{
+    const uint8_t *frames;  // frame_count bitmaps of 8 (5x8) or 10 (5x10) rows each
+    uint8_t frame_count;
+    uint8_t frame;          // Frame currently held by CGRAM
+    uint8_t next;           // Frame uploaded when due
+    bool active;
+    bool loaded;            // CGRAM holds a frame of this sequence, only changed rows are uploaded
+    uint32_t period;        // Time between two frames
+    uint32_t due;           // Time of the next frame
+}lcd_anim_slot_s;
+
+// Animation state for all CGRAM slots
+typedef struct{
+    lcd_anim_slot_s slots[LCD_ANIM_SLOTS];
+    uint8_t slot_count;     // Slots available with the configured font
+    uint8_t rows;           // Rows per bitmap
+    uint8_t stride;         // CGRAM address distance between two slots
+}lcd_anim_s;
+
+// Initialize the animation state for the font of the configuration
+void lcd_anim_init(lcd_anim_s *anim, const lcd_config_s *config);
+
+// Show frames on a slot, the first frame is uploaded by the next tick
+// Slots reserved for charset fallback glyphs must not be animated
+// Times use the unit of the caller's clock, -1 if slot or sequence are invalid
+int lcd_anim_start(lcd_anim_s *anim, uint8_t slot, const uint8_t *frames, uint8_t frame_count, uint32_t period, uint32_t now);
+// Keep the current frame of a slot
+void lcd_anim_stop(lcd_anim_s *anim, uint8_t slot);
+
+// Advance the most overdue slot if its frame is due, call periodically from the main loop
+// Returns without bus access if nothing is due, returns the updated slot or -1
+// A due frame blocks for its upload: CGRAM address, rows and one address restore per controller, each followed by
+// CMD_DELAY_US, plus bus time (host simulation at 100 kHz: 38 ms with bursts, 54 ms without; 50/67 ms on 40x4)
+// Frame periods shorter than the upload time are stretched to it
+// A frame lost to a bus failure stays due and is uploaded completely by the next call
+int lcd_anim_tick(lcd_anim_s *anim, lcd_config_s *config, interface_s *interface, uint32_t now);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* LCD_ANIM_H */
@@ -0,0 +1,272 @@
+#include <stddef.h>
+#include "lcd_charset.h"
+
+/* Character ROM tables
+ * Code points are grouped in blocks of 32, only blocks holding at least one glyph are stored.
+ * Block lists and glyph lists below are expanded at compile time into one dense table per ROM,
+ * a code point is translated with a single switch on its block and one table access. */
+
+#define LCD_BLOCK_SIZE          32
+#define LCD_BLOCK(cp)           ((cp) / LCD_BLOCK_SIZE)
+
+// Blocks of the A00 (Japanese) ROM
+#define LCD_A00_BLOCKS(X) \
+    X(A00, 0x00A0) X(A00, 0x00C0) X(A00, 0x00E0) X(A00, 0x03A0) X(A00, 0x03C0) \
+    X(A00, 0x2180) X(A00, 0x2200) X(A00, 0x2580) X(A00, 0x3000) X(A00, 0x30E0)
+
+// Block, code point and character code of the A00 ROM
+#define LCD_A00_GLYPHS(X) \
+    X(A00, 0x00A0, 0x00A2, 0xEC)    /* CENT SIGN */ \
+    X(A00, 0x00A0, 0x00A5, 0x5C)    /* YEN SIGN */ \
+    X(A00, 0x00A0, 0x00B0, 0xDF)    /* DEGREE SIGN */ \
+    X(A00, 0x00A0, 0x00B5, 0xE4)    /* MICRO SIGN */ \
+    X(A00, 0x00A0, 0x00B7, 0xA5)    /* MIDDLE DOT */ \
+    X(A00, 0x00A0, 0x00BF, 0x3F)    /* INVERTED QUESTION MARK (approximated) */ \
+    X(A00, 0x00C0, 0x00DF, 0xE2)    /* SHARP S (shown as beta) */ \
+    X(A00, 0x00E0, 0x00E4, 0xE1)    /* A WITH DIAERESIS */ \
+    X(A00, 0x00E0, 0x00F1, 0xEE)    /* N WITH TILDE */ \
+    X(A00, 0x00E0, 0x00F6, 0xEF)    /* O WITH DIAERESIS */ \
+    X(A00, 0x00E0, 0x00F7, 0xFD)    /* DIVISION SIGN */ \
+    X(A00, 0x00E0, 0x00FC, 0xF5)    /* U WITH DIAERESIS */ \
+    X(A00, 0x03A0, 0x03A3, 0xF6)    /* CAPITAL SIGMA */ \
+    X(A00, 0x03A0, 0x03A9, 0xF4)    /* CAPITAL OMEGA */ \
+    X(A00, 0x03A0, 0x03B1, 0xE0)    /* SMALL ALPHA */ \
+    X(A00, 0x03A0, 0x03B2, 0xE2)    /* SMALL BETA */ \
+    X(A00, 0x03A0, 0x03B5, 0xE3)    /* SMALL EPSILON */ \
+    X(A00, 0x03A0, 0x03B8, 0xF2)    /* SMALL THETA */ \
+    X(A00, 0x03A0, 0x03BC, 0xE4)    /* SMALL MU */ \
+    X(A00, 0x03C0, 0x03C0, 0xF7)    /* SMALL PI */ \
+    X(A00, 0x03C0, 0x03C1, 0xE6)    /* SMALL RHO */ \
+    X(A00, 0x03C0, 0x03C3, 0xE5)    /* SMALL SIGMA */ \
+    X(A00, 0x2180, 0x2190, 0x7F)    /* LEFTWARDS ARROW */ \
+    X(A00, 0x2180, 0x2192, 0x7E)    /* RIGHTWARDS ARROW */ \
+    X(A00, 0x2200, 0x2211, 0xF6)    /* N-ARY SUMMATION */ \
+    X(A00, 0x2200, 0x221A, 0xE8)    /* SQUARE ROOT */ \
+    X(A00, 0x2200, 0x221E, 0xF3)    /* INFINITY */ \
+    X(A00, 0x2580, 0x2588, 0xFF)    /* FULL BLOCK */ \
+    X(A00, 0x3000, 0x3001, 0xA4)    /* IDEOGRAPHIC COMMA */ \
+    X(A00, 0x3000, 0x3002, 0xA1)    /* IDEOGRAPHIC FULL STOP */ \
+    X(A00, 0x3000, 0x300C, 0xA2)    /* LEFT CORNER BRACKET */ \
+    X(A00, 0x3000, 0x300D, 0xA3)    /* RIGHT CORNER BRACKET */ \
+    X(A00, 0x30E0, 0x30FB, 0xA5)    /* KATAKANA MIDDLE DOT */
+
+// Blocks of the A02 (Western European) ROM
+#define LCD_A02_BLOCKS(X) \
+    X(A02, 0x00A0) X(A02, 0x2000) X(A02, 0x2180) X(A02, 0x21A0) X(A02, 0x2260) \
+    X(A02, 0x2300) X(A02, 0x25A0) X(A02, 0x25C0)
+
+// Block, code point and character code of the A02 ROM, Latin-1 letters 0xC0..0xFF are mapped 1:1
+#define LCD_A02_GLYPHS(X) \
+    X(A02, 0x00A0, 0x00A1, 0xA1)    /* INVERTED EXCLAMATION MARK */ \
+    X(A02, 0x00A0, 0x00A2, 0xA2)    /* CENT SIGN */ \
+    X(A02, 0x00A0, 0x00A3, 0xA3)    /* POUND SIGN */ \
+    X(A02, 0x00A0, 0x00A5, 0xA5)    /* YEN SIGN */ \
+    X(A02, 0x00A0, 0x00A7, 0xA7)    /* SECTION SIGN */ \
+    X(A02, 0x00A0, 0x00A9, 0xA9)    /* COPYRIGHT SIGN */ \
+    X(A02, 0x00A0, 0x00AB, 0xAB)    /* LEFT GUILLEMET */ \
+    X(A02, 0x00A0, 0x00B0, 0xB0)    /* DEGREE SIGN */ \
+    X(A02, 0x00A0, 0x00B1, 0xB1)    /* PLUS-MINUS SIGN */ \
+    X(A02, 0x00A0, 0x00B2, 0xB2)    /* SUPERSCRIPT TWO */ \
+    X(A02, 0x00A0, 0x00B3, 0xB3)    /* SUPERSCRIPT THREE */ \
+    X(A02, 0x00A0, 0x00B5, 0xB5)    /* MICRO SIGN */ \
+    X(A02, 0x00A0, 0x00B6, 0xB6)    /* PILCROW SIGN */ \
+    X(A02, 0x00A0, 0x00B7, 0xB7)    /* MIDDLE DOT */ \
+    X(A02, 0x00A0, 0x00B9, 0xB9)    /* SUPERSCRIPT ONE */ \
+    X(A02, 0x00A0, 0x00BB, 0xBB)    /* RIGHT GUILLEMET */ \
+    X(A02, 0x00A0, 0x00BC, 0xBC)    /* ONE QUARTER */ \
+    X(A02, 0x00A0, 0x00BD, 0xBD)    /* ONE HALF */ \
+    X(A02, 0x00A0, 0x00BE, 0xBE)    /* THREE QUARTERS */ \
+    X(A02, 0x00A0, 0x00BF, 0xBF)    /* INVERTED QUESTION MARK */ \
+    X(A02, 0x2000, 0x201C, 0x12)    /* LEFT DOUBLE QUOTATION MARK */ \
+    X(A02, 0x2000, 0x201D, 0x13)    /* RIGHT DOUBLE QUOTATION MARK */ \
+    X(A02, 0x2180, 0x2190, 0x1B)    /* LEFTWARDS ARROW */ \
+    X(A02, 0x2180, 0x2191, 0x18)    /* UPWARDS ARROW */ \
+    X(A02, 0x2180, 0x2192, 0x1A)    /* RIGHTWARDS ARROW */ \
+    X(A02, 0x2180, 0x2193, 0x19)    /* DOWNWARDS ARROW */ \
+    X(A02, 0x21A0, 0x21B5, 0x17)    /* DOWNWARDS ARROW WITH CORNER LEFTWARDS */ \
+    X(A02, 0x2260, 0x2264, 0x1C)    /* LESS-THAN OR EQUAL TO */ \
+    X(A02, 0x2260, 0x2265, 0x1D)    /* GREATER-THAN OR EQUAL TO */ \
+    X(A02, 0x2300, 0x2302, 0x7F)    /* HOUSE */ \
+    X(A02, 0x25A0, 0x25B2, 0x1E)    /* BLACK UP-POINTING TRIANGLE */ \
+    X(A02, 0x25A0, 0x25B6, 0x10)    /* BLACK RIGHT-POINTING TRIANGLE */ \
+    X(A02, 0x25A0, 0x25BC, 0x1F)    /* BLACK DOWN-POINTING TRIANGLE */ \
+    X(A02, 0x25C0, 0x25C0, 0x11)    /* BLACK LEFT-POINTING TRIANGLE */ \
+    X(A02, 0x25C0, 0x25CF, 0x16)    /* BLACK CIRCLE */
+
+// Dense block indices per ROM
+#define LCD_BLOCK_INDEX(rom, base)              LCD_##rom##_BLOCK_##base,
+enum {LCD_A00_BLOCKS(LCD_BLOCK_INDEX) LCD_A00_BLOCK_COUNT};
+enum {LCD_A02_BLOCKS(LCD_BLOCK_INDEX) LCD_A02_BLOCK_COUNT};
+
+// Code points outside of their block do not compile (index exceeds the array bounds)
+#define LCD_GLYPH_ENTRY(rom, base, cp, code)    [LCD_##rom##_BLOCK_##base][(cp) - (base)] = (code),
+static const uint8_t lcd_rom_table_A00[LCD_A00_BLOCK_COUNT][LCD_BLOCK_SIZE] = {LCD_A00_GLYPHS(LCD_GLYPH_ENTRY)};
+static const uint8_t lcd_rom_table_A02[LCD_A02_BLOCK_COUNT][LCD_BLOCK_SIZE] = {LCD_A02_GLYPHS(LCD_GLYPH_ENTRY)};
+
+#define LCD_BLOCK_CASE(rom, base) \
+    case LCD_BLOCK(base): *code = lcd_rom_table_##rom[LCD_##rom##_BLOCK_##base][code_point % LCD_BLOCK_SIZE]; break;
+
+/* Fallback glyphs */
+
+const lcd_glyph_s lcd_charset_default_glyphs[] = {
+    {0x005C, {0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00, 0x00}},    // Backslash (A00 shows yen)
+    {0x007E, {0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00, 0x00}},    // Tilde (A00 shows arrow)
+    {0x00C4, {0x0A, 0x00, 0x0E, 0x11, 0x1F, 0x11, 0x11, 0x00}},    // A with diaeresis
+    {0x00D6, {0x0A, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x0E, 0x00}},    // O with diaeresis
+    {0x00DC, {0x0A, 0x00, 0x11, 0x11, 0x11, 0x11, 0x0E, 0x00}},    // U with diaeresis
+    {0x20AC, {0x06, 0x09, 0x1C, 0x08, 0x1C, 0x09, 0x06, 0x00}},    // Euro sign
+};
+const uint8_t lcd_charset_default_glyph_count = sizeof(lcd_charset_default_glyphs) / sizeof(lcd_charset_default_glyphs[0]);
+
+/* Functions */
+
+void lcd_charset_init(lcd_charset_s *charset, lcd_rom_e rom, const lcd_glyph_s *glyphs, uint8_t glyph_count, uint8_t first_slot, uint8_t slot_count){
+    charset->rom = rom;
+    charset->code_point = 0;
+    charset->pending = 0;
+    charset->glyphs = glyphs;
+    charset->glyph_count = glyph_count;
+    charset->first_slot = first_slot;
+    charset->slot_count = slot_count;
+
+    // All slots are free
+    for (int i = 0; i < LCD_CGRAM_SLOTS; i++){
+        charset->slot_cp[i] = 0;
+        charset->slot_used[i] = 0;
+    }
+    charset->clock = 0;
+
+    // Limit reserved slots to the available CGRAM
+    lcd_charset_limit(charset, LCD_CGRAM_SLOTS);
+}
+
+void lcd_charset_limit(lcd_charset_s *charset, uint8_t slots){
+    if (charset->first_slot >= slots)
+        charset->slot_count = 0;
+    else if (charset->first_slot + charset->slot_count > slots)
+        charset->slot_count = slots - charset->first_slot;
+
+    // Slots outside of the limit hold no glyph
+    for (int i = slots; i < LCD_CGRAM_SLOTS; i++)
+        charset->slot_cp[i] = 0;
+}
+
+bool lcd_utf8_decode(lcd_charset_s *charset, uint8_t byte, uint32_t *code_point){
+    // Continuation byte of a pending sequence
+    if (charset->pending > 0 && (byte & 0xC0) == 0x80){
+        charset->code_point = (charset->code_point << 6) | (byte & 0x3F);
+        if (--charset->pending > 0)
+            return false;
+        *code_point = charset->code_point;
+        return true;
+    }
+
+    // New sequence, an interrupted sequence is dropped
+    charset->pending = 0;
+    if (byte < 0x80){
+        *code_point = byte;
+        return true;
+    }
+    else if ((byte & 0xE0) == 0xC0){
+        charset->code_point = byte & 0x1F;
+        charset->pending = 1;
+    }
+    else if ((byte & 0xF0) == 0xE0){
+        charset->code_point = byte & 0x0F;
+        charset->pending = 2;
+    }
+    else if ((byte & 0xF8) == 0xF0){
+        charset->code_point = byte & 0x07;
+        charset->pending = 3;
+    }
+    else{
+        // Stray continuation byte or invalid lead byte
+        *code_point = LCD_UTF8_INVALID;
+        return true;
+    }
+    return false;
+}
+
+bool lcd_charset_rom(lcd_rom_e rom, uint32_t code_point, uint8_t *code){
+    // Control codes pass through to reach CGRAM characters and A02 symbols
+    // Code 0x00 is CGRAM character 0 here, the tables use it for missing glyphs only
+    if (code_point < 0x20){
+        *code = (uint8_t) code_point;
+        return true;
+    }
+
+    *code = LCD_CHARSET_NO_GLYPH;
+    if (rom == LCD_ROM_A00){
+        // ASCII except backslash and tilde which hold yen and arrow
+        if (code_point < 0x7E){
+            *code = (uint8_t) code_point;
+            return code_point != 0x5C;
+        }
+        // Halfwidth katakana are in Unicode order
+        if (code_point >= 0xFF61 && code_point <= 0xFF9F){
+            *code = (uint8_t) (code_point - 0xFF61 + 0xA1);
+            return true;
+        }
+
+        switch (LCD_BLOCK(code_point)){
+            LCD_A00_BLOCKS(LCD_BLOCK_CASE)
+            default: break;
+        }
+    }
+    else{
+        // ASCII and Latin-1 letters
+        if (code_point < 0x7F || (code_point >= 0xC0 && code_point <= 0xFF)){
+            *code = (uint8_t) code_point;
+            return true;
+        }
+
+        switch (LCD_BLOCK(code_point)){
+            LCD_A02_BLOCKS(LCD_BLOCK_CASE)
+            default: break;
+        }
+    }
+    return *code != LCD_CHARSET_NO_GLYPH;
+}
+
+int lcd_charset_slot(lcd_charset_s *charset, uint32_t code_point, const lcd_glyph_s **upload){
+    const lcd_glyph_s *glyph = NULL;
+    uint8_t slot = charset->first_slot;
+
+    *upload = NULL;
+    if (charset->slot_count == 0)
+        return -1;
+    charset->clock++;
+
+    // Glyph already in CGRAM
+    for (uint8_t i = charset->first_slot; i < charset->first_slot + charset->slot_count; i++){
+        if (charset->slot_cp[i] != 0 && charset->slot_cp[i] == code_point){
+            charset->slot_used[i] = charset->clock;
+            return i;
+        }
+    }
+
+    // Find fallback bitmap
+    for (uint8_t i = 0; i < charset->glyph_count; i++){
+        if (charset->glyphs[i].code_point == code_point){
+            glyph = &charset->glyphs[i];
+            break;
+        }
+    }
+    if (glyph == NULL)
+        return -1;
+
+    // Replace free or least recently used slot
+    // Cells still showing the replaced glyph change as well
+    for (uint8_t i = charset->first_slot; i < charset->first_slot + charset->slot_count; i++){
+        if (charset->slot_cp[i] == 0){
+            slot = i;
+            break;
+        }
+        if ((uint16_t) (charset->clock - charset->slot_used[i]) > (uint16_t) (charset->clock - charset->slot_used[slot]))
+            slot = i;
+    }
+    charset->slot_cp[slot] = glyph->code_point;
+    charset->slot_used[slot] = charset->clock;
+    *upload = glyph;
+    return slot;
+}
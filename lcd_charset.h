@@ -0,0 +1,65 @@
+#ifndef LCD_CHARSET_H
+#define	LCD_CHARSET_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LCD_CHARSET_NO_GLYPH        0x00    // Table value for code points without ROM glyph, never returned as code
+#define LCD_CHARSET_REPLACEMENT     '?'     // Printed if neither ROM nor CGRAM glyph exists
+#define LCD_UTF8_INVALID            0xFFFD  // Code point reported for malformed sequences
+#define LCD_CGRAM_SLOTS             8       // Custom characters in 5x8 font
+#define LCD_CGRAM_SLOTS_5x10        4       // Custom characters in 5x10 font
+
+// Enumerator for the character ROM of the controller
+typedef enum {LCD_ROM_A00, LCD_ROM_A02} lcd_rom_e;
+
+// Bitmap for a code point without ROM glyph, uploaded to CGRAM on demand
+typedef struct{
+    uint16_t code_point;
+    uint8_t bitmap[10];     // Rows of the character, only the first 8 are used with 5x8 font
+}lcd_glyph_s;
+
+// Streaming UTF-8 decoder and CGRAM slot allocation
+typedef struct{
+    lcd_rom_e rom;                          // Character ROM of the controller
+    uint32_t code_point;                    // Code point being decoded
+    uint8_t pending;                        // Continuation bytes still expected
+    const lcd_glyph_s *glyphs;              // Fallback bitmaps
+    uint8_t glyph_count;
+    uint8_t first_slot;                     // First CGRAM slot used for fallback glyphs
+    uint8_t slot_count;                     // Number of CGRAM slots used for fallback glyphs
+    uint16_t slot_cp[LCD_CGRAM_SLOTS];      // Code point held by each slot, 0 if free
+    uint16_t slot_used[LCD_CGRAM_SLOTS];    // Time stamp of last use for replacement
+    uint16_t clock;
+}lcd_charset_s;
+
+// Bitmaps for common characters missing in both ROMs
+extern const lcd_glyph_s lcd_charset_default_glyphs[];
+extern const uint8_t lcd_charset_default_glyph_count;
+
+// Initialize the transcoder, slots first_slot..first_slot+slot_count-1 are reserved for fallback glyphs
+void lcd_charset_init(lcd_charset_s *charset, lcd_rom_e rom, const lcd_glyph_s *glyphs, uint8_t glyph_count, uint8_t first_slot, uint8_t slot_count);
+
+// Restrict the reserved slots to the first slots of CGRAM, glyphs held by removed slots are dropped
+void lcd_charset_limit(lcd_charset_s *charset, uint8_t slots);
+
+// Feed one byte, returns true when a code point is complete
+bool lcd_utf8_decode(lcd_charset_s *charset, uint8_t byte, uint32_t *code_point);
+
+// Character code of a code point in the ROM, false if there is none
+// Control codes 0x00-0x1F map to themselves, 0x00-0x07 show the CGRAM characters
+bool lcd_charset_rom(lcd_rom_e rom, uint32_t code_point, uint8_t *code);
+
+// CGRAM slot showing a code point, -1 if there is no fallback glyph
+// If the slot has to be (re)written, *upload points to the glyph, otherwise it is NULL
+int lcd_charset_slot(lcd_charset_s *charset, uint32_t code_point, const lcd_glyph_s **upload);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* LCD_CHARSET_H */
@@ -0,0 +1,168 @@
+#include <stdint.h>
+#include <stddef.h>
+#include "lcd_layout.h"
+
+#define LAYOUT_BLANK    ' '
+
+// Layout of a window computed in RAM before anything is written
+typedef struct{
+    uint8_t cells[MAX_ROWS_SUPPORTED][MAX_COLS_SUPPORTED];
+    uint8_t len[MAX_ROWS_SUPPORTED];
+    uint8_t width;
+    uint8_t height;
+    uint8_t line;           // Line being filled
+    uint16_t clipped;       // Characters that did not fit, blanks are not counted
+    bool full;              // No line left for wrapping, every further word is clipped
+}layout_s;
+
+// Start the next line, false if the window is full
+static bool layout_newline(layout_s *layout){
+    if (layout->line + 1 >= layout->height)
+        return false;
+    layout->line++;
+    return true;
+}
+
+// Append a word to the current line, breaking it if it is wider than the window
+static void layout_word(layout_s *layout, const uint8_t *word, uint8_t len, uint8_t spaces, bool wrap){
+    uint8_t *line_len = &layout->len[layout->line];
+    
+    // Nothing is placed behind a word that was dropped, the text would be out of order
+    if (layout->full){
+        layout->clipped += len;
+        return;
+    }
+    
+    if (wrap){
+        // Move words that do not fit to the next line, spaces before them are dropped
+        if (*line_len > 0 && *line_len + spaces + len > layout->width && len <= layout->width){
+            if (!layout_newline(layout)){
+                layout->full = true;
+                layout->clipped += len;
+                return;
+            }
+            line_len = &layout->len[layout->line];
+            spaces = 0;
+        }
+        // Spaces at the start of wrapped lines are dropped
+        if (*line_len == 0 && layout->line > 0)
+            spaces = 0;
+    }
+    
+    for (uint8_t i = 0; i < spaces + len; i++){
+        if (*line_len >= layout->width){
+            // Hard break of words longer than the window, clipping otherwise
+            if (!wrap || !layout_newline(layout)){
+                layout->full = wrap;
+                layout->clipped += (i < spaces) ? len : spaces + len - i;
+                return;
+            }
+            line_len = &layout->len[layout->line];
+            if (i < spaces)
+                continue;
+        }
+        layout->cells[layout->line][(*line_len)++] = (i < spaces) ? LAYOUT_BLANK : word[i - spaces];
+    }
+}
+
+void lcd_window_configure(lcd_window_s *window, uint8_t row, uint8_t col, uint8_t width, uint8_t height, lcd_align_e align, uint8_t flags){
+    window->row = row;
+    window->col = col;
+    window->width = width;
+    window->height = height;
+    window->align = align;
+    window->flags = flags;
+}
+
+int lcd_layout_print(lcd_config_s *config, interface_s *interface, const lcd_window_s *window, const char *text){
+    layout_s layout;
+    uint8_t word[MAX_COLS_SUPPORTED];
+    uint8_t word_len = 0;
+    uint8_t spaces = 0;
+    bool wrap = (window->flags & LCD_LAYOUT_WRAP) != 0;
+    int code;
+    
+    // Clip the window to the display
+    if (window->row >= config->rows || window->col >= config->cols)
+        return 0;
+    layout.width = (window->width < config->cols - window->col) ? window->width : config->cols - window->col;
+    layout.height = (window->height < config->rows - window->row) ? window->height : config->rows - window->row;
+    layout.line = 0;
+    layout.clipped = 0;
+    layout.full = false;
+    for (uint8_t i = 0; i < MAX_ROWS_SUPPORTED; i++)
+        layout.len[i] = 0;
+    if (layout.width == 0 || layout.height == 0)
+        return 0;
+    
+    // Split the text into words and lines
+    // End of text, blanks and line breaks are taken from the source bytes, code 0x00 is CGRAM character 0
+    for (const char *c = text; ; c++){
+        if (*c != '\0'){
+            code = lcd_translate(config, interface, (uint8_t) *c);
+            if (code == LCD_CODE_ERROR)
+                return -1;
+            if (code < 0)
+                continue;
+        }
+        
+        // A word ends at a blank, line break or the end of the text
+        if (*c == ' ' || *c == '\n' || *c == '\0'){
+            if (word_len > 0){
+                layout_word(&layout, word, word_len, spaces, wrap);
+                word_len = 0;
+                spaces = 0;
+            }
+            if (*c == ' '){
+                spaces++;
+                continue;
+            }
+            
+            // Blanks at the end of a line are dropped
+            spaces = 0;
+            if (*c == '\0')
+                break;
+            if (!layout_newline(&layout)){
+                // Count the rest of the text as clipped, in characters like the cells of the layout
+                // Continuation bytes of UTF-8 sequences belong to the character of their lead byte
+                for (c++; *c != '\0'; c++){
+                    bool continuation = config->charset != NULL && ((uint8_t) *c & 0xC0) == 0x80;
+                    layout.clipped += (*c != '\n' && *c != ' ' && !continuation);
+                }
+                break;
+            }
+            continue;
+        }
+        
+        // Words wider than the window are flushed in pieces
+        if (word_len == sizeof(word)){
+            layout_word(&layout, word, word_len, spaces, wrap);
+            word_len = 0;
+            spaces = 0;
+        }
+        word[word_len++] = (uint8_t) code;
+    }
+    
+    // Write each row as one address set and one contiguous run
+    for (uint8_t line = 0; line < layout.height; line++){
+        uint8_t len = layout.len[line];
+        uint8_t offset = 0;
+        
+        if (window->align == LCD_ALIGN_CENTER)
+            offset = (layout.width - len) / 2;
+        else if (window->align == LCD_ALIGN_RIGHT)
+            offset = layout.width - len;
+        
+        if (window->flags & LCD_LAYOUT_PAD){
+            // Blanks around the text erase what was shown before
+            uint8_t cells[MAX_COLS_SUPPORTED];
+            for (uint8_t i = 0; i < layout.width; i++)
+                cells[i] = (i >= offset && i < offset + len) ? layout.cells[line][i - offset] : LAYOUT_BLANK;
+            if (!lcd_write_buffer(config, interface, window->row + line, window->col, cells, layout.width))
+                return -1;
+        }
+        else if (len > 0 && !lcd_write_buffer(config, interface, window->row + line, window->col + offset, layout.cells[line], len))
+            return -1;
+    }
+    return layout.clipped;
+}
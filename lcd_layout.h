@@ -0,0 +1,40 @@
+#ifndef LCD_LAYOUT_H
+#define	LCD_LAYOUT_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lcd.h"
+    
+// Layout flags
+#define LCD_LAYOUT_WRAP         0x01    // Break lines between words, otherwise lines are clipped
+#define LCD_LAYOUT_PAD          0x02    // Fill unused cells of the window with blanks
+    
+// Enumerator for horizontal alignment within a window
+typedef enum {LCD_ALIGN_LEFT, LCD_ALIGN_CENTER, LCD_ALIGN_RIGHT} lcd_align_e;
+
+// Rectangular text window
+typedef struct{
+    uint8_t row;        // Top row
+    uint8_t col;        // Left column
+    uint8_t width;      // Columns
+    uint8_t height;     // Rows
+    lcd_align_e align;
+    uint8_t flags;
+}lcd_window_s;
+
+// Edit the window configuration
+void lcd_window_configure(lcd_window_s *window, uint8_t row, uint8_t col, uint8_t width, uint8_t height, lcd_align_e align, uint8_t flags);
+
+// Lay out text in a window and write it row by row, '\n' starts a new line
+// Returns the number of characters that did not fit, a multi-byte UTF-8 character counts once, -1 if the bus failed
+int lcd_layout_print(lcd_config_s *config, interface_s *interface, const lcd_window_s *window, const char *text);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* LCD_LAYOUT_H */
@@ -0,0 +1,243 @@
+/*
+ * Statically configured LCD driver, alternative to lcd.c for a single display.
+ * Bus width, geometry and backend are fixed by macros before including this file,
+ * every function is inlined into direct writes of the expander output byte.
+ *
+ * Configuration (defaults in brackets):
+ *   LCD_STATIC_BUS_WIDTH       4 or 8 [4]
+ *   LCD_STATIC_ROWS            Number of rows [2]
+ *   LCD_STATIC_COLS            Number of columns [16]
+ *   LCD_STATIC_FONT_5x10       Define to use the 5x10 font
+ *   LCD_STATIC_I2C_WRITE       I2C_Fcn compatible write function (4-bit via PCF8574)
+ *   LCD_STATIC_I2C_ADDR        I2C address of the PCF8574
+ *   LCD_STATIC_GPIO_WRITE(ctrl, data)  Output function for 8-bit bus, ctrl uses the PCF8574 pin mapping
+ *   LCD_STATIC_LATENCY_US      Time from a write call until the outputs change, subtracted from delays [0]
+ *   F_CPU                      CPU clock for delay.h, 8000000UL or 48000000UL (required)
+ *   LCD_STATIC_EXTERN_DELAY    Define in all but one translation unit including this file [undefined]
+ *
+ * delay.h defines delay_usec() with external linkage, so only one translation unit of the program
+ * may include it. The others define LCD_STATIC_EXTERN_DELAY and only declare the function.
+ */
+
+#ifndef LCD_STATIC_H
+#define	LCD_STATIC_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lcd.h"
+#include "PCF8574.h"
+#ifdef LCD_STATIC_EXTERN_DELAY
+void delay_usec(uint32_t n);
+#else
+#include "delay.h"
+#endif
+
+#ifndef LCD_STATIC_BUS_WIDTH
+#define LCD_STATIC_BUS_WIDTH    4
+#endif
+#ifndef LCD_STATIC_ROWS
+#define LCD_STATIC_ROWS         2
+#endif
+#ifndef LCD_STATIC_COLS
+#define LCD_STATIC_COLS         16
+#endif
+#ifndef LCD_STATIC_LATENCY_US
+#define LCD_STATIC_LATENCY_US   0
+#endif
+
+#if LCD_STATIC_ROWS < 1 || LCD_STATIC_ROWS > MAX_ROWS_SUPPORTED || LCD_STATIC_COLS < 1 || LCD_STATIC_COLS > MAX_COLS_SUPPORTED
+#error Unsupported LCD_STATIC_ROWS / LCD_STATIC_COLS
+#endif
+// One controller holds 80 characters, larger panels (e.g. 40x4) need the second enable line of lcd.c
+#if LCD_STATIC_ROWS * LCD_STATIC_COLS > 80
+#error Dual-controller panels are not supported by lcd_static.h, use lcd.c
+#endif
+
+#if LCD_STATIC_BUS_WIDTH == 4
+#if !defined(LCD_STATIC_I2C_WRITE) || !defined(LCD_STATIC_I2C_ADDR)
+#error LCD_STATIC_I2C_WRITE and LCD_STATIC_I2C_ADDR have to be defined for 4-bit bus
+#endif
+#elif LCD_STATIC_BUS_WIDTH == 8
+#ifndef LCD_STATIC_GPIO_WRITE
+#error LCD_STATIC_GPIO_WRITE has to be defined for 8-bit bus
+#endif
+#else
+#error LCD_STATIC_BUS_WIDTH has to be 4 or 8
+#endif
+
+// Line addresses, rows 2 and 3 of 16 column displays continue rows 0 and 1 after 16 cells
+#define LCD_STATIC_LINE2_ADDR   ((LCD_STATIC_COLS == 16) ? LCD_LINE0_ADDR + 16 : LCD_LINE2_ADDR)
+#define LCD_STATIC_LINE3_ADDR   ((LCD_STATIC_COLS == 16) ? LCD_LINE1_ADDR + 16 : LCD_LINE3_ADDR)
+#define LCD_STATIC_LINE_ADDR(row) \
+    ((row) == 0 ? LCD_LINE0_ADDR : (row) == 1 ? LCD_LINE1_ADDR : (row) == 2 ? LCD_STATIC_LINE2_ADDR : LCD_STATIC_LINE3_ADDR)
+
+// Function set for the configured panel
+#ifdef LCD_STATIC_FONT_5x10
+#define LCD_STATIC_FONT         LCD_5F10
+#else
+#define LCD_STATIC_FONT         LCD_5F8
+#endif
+#define LCD_STATIC_FUNCTION     (LCD_FUNCTION_SET | \
+                                 ((LCD_STATIC_BUS_WIDTH == 8) ? LCD_8BIT : LCD_4BIT) | \
+                                 ((LCD_STATIC_ROWS > 1) ? LCD_2_LINE : LCD_1_LINE) | \
+                                 LCD_STATIC_FONT)
+
+// Control lines packed in the expander output byte (replaces lcd_cmd_s)
+#define LCD_STATIC_RS           (1 << RS_PIN)
+#define LCD_STATIC_E            (1 << E_PIN)
+#define LCD_STATIC_LEDK         (1 << LEDK_PIN)
+
+// Map the upper data nibble to the expander pins, folds to a mask for the default mapping
+#define LCD_STATIC_NIBBLE(data) \
+    ((((data) >> 4) & 1) << DB4_PIN | (((data) >> 5) & 1) << DB5_PIN | \
+     (((data) >> 6) & 1) << DB6_PIN | (((data) >> 7) & 1) << DB7_PIN)
+
+/* Low-level functions */
+
+#if LCD_STATIC_BUS_WIDTH == 4
+static inline void lcd_static_out(uint8_t ctrl, uint8_t data){
+    uint8_t out = ctrl | LCD_STATIC_NIBBLE(data);
+    LCD_STATIC_I2C_WRITE(LCD_STATIC_I2C_ADDR, &out, 1);
+}
+#else
+static inline void lcd_static_out(uint8_t ctrl, uint8_t data){
+    LCD_STATIC_GPIO_WRITE(ctrl, data);
+}
+#endif
+
+// Wait before the next write, folds to a constant or nothing
+static inline void lcd_static_delay(uint32_t us){
+    if (us > LCD_STATIC_LATENCY_US)
+        delay_usec(us - LCD_STATIC_LATENCY_US);
+}
+
+// Same edge sequence and delays as lcd_write() of the generic driver
+static inline void lcd_static_write(uint8_t cmd, uint8_t is_data){
+    uint8_t ctrl = LCD_STATIC_LEDK | (is_data ? LCD_STATIC_RS : 0);
+
+#if LCD_STATIC_BUS_WIDTH == 4
+    // Set control lines
+    lcd_static_out(ctrl, 0x00);
+    lcd_static_delay(DATA_OUTPUT_DELAY_US);
+    lcd_static_out(ctrl | LCD_STATIC_E, 0x00);
+    lcd_static_delay(DATA_OUTPUT_DELAY_US);
+
+    // Send upper nibble with high-low transition on Enable bit
+    lcd_static_out(ctrl | LCD_STATIC_E, cmd & 0xf0);
+    lcd_static_delay(LEVEL_DELAY_US);
+    lcd_static_out(ctrl, cmd & 0xf0);
+    lcd_static_delay(DATA_HOLD_DELAY_US);
+
+    // Send lower nibble with high-low transition on Enable bit
+    lcd_static_out(ctrl | LCD_STATIC_E, (cmd & 0x0f) << 4);
+    lcd_static_delay(LEVEL_DELAY_US);
+    lcd_static_out(ctrl, (cmd & 0x0f) << 4);
+#else
+    // Send command word at once with high-low transition on Enable bit
+    lcd_static_out(ctrl | LCD_STATIC_E, cmd);
+    lcd_static_delay(LEVEL_DELAY_US);
+    lcd_static_out(ctrl, cmd);
+#endif
+
+    // Hold time and execution in one delay, the next write covers the transfer time once
+    lcd_static_delay(DATA_HOLD_DELAY_US + CMD_DELAY_US);
+}
+
+// Single 8-bit mode write of the upper nibble during initialization
+static inline void lcd_static_write_init(uint8_t cmd){
+    lcd_static_out(LCD_STATIC_LEDK | LCD_STATIC_E, cmd);
+    lcd_static_delay(LEVEL_DELAY_US);
+    lcd_static_out(LCD_STATIC_LEDK, cmd);
+    lcd_static_delay(DATA_HOLD_DELAY_US + CMD_DELAY_US);
+}
+
+/* High level functions for user */
+
+static inline void lcd_static_init(void){
+    // Send 3x 0x30 with delays in between, busy flag is still unavailable
+    lcd_static_delay(BOOT_DELAY_US);
+    lcd_static_write_init(LCD_FUNCTION_SET | LCD_8BIT);
+    delay_usec(BOOT_DELAY_US/5);
+    lcd_static_write_init(LCD_FUNCTION_SET | LCD_8BIT);
+    delay_usec(BOOT_DELAY_US/10);
+    lcd_static_write_init(LCD_FUNCTION_SET | LCD_8BIT);
+
+    // Set bus width, then the full configuration
+#if LCD_STATIC_BUS_WIDTH == 4
+    lcd_static_write_init(LCD_FUNCTION_SET | LCD_4BIT);
+#endif
+    lcd_static_write(LCD_STATIC_FUNCTION, 0);
+
+    // Display on, no cursor, no blink, clear, increment without shift
+    lcd_static_write(LCD_DISPLAY_CONTROL | LCD_CURSOR_OFF | LCD_BLINK_OFF | LCD_DISPLAY_ON, 0);
+    lcd_static_write(LCD_CLEAR_DISPLAY, 0);
+    lcd_static_write(LCD_ENTRY_MODE_SET | LCD_INCREMENT | LCD_NO_SHIFT, 0);
+    lcd_static_write(LCD_RETURN_HOME, 0);
+}
+
+static inline void lcd_static_clear(void){
+    lcd_static_write(LCD_CLEAR_DISPLAY, 0);
+}
+
+static inline void lcd_static_home(void){
+    lcd_static_write(LCD_RETURN_HOME, 0);
+}
+
+// Display control flags LCD_DISPLAY_ON, LCD_CURSOR_ON, LCD_BLINK_ON
+static inline void lcd_static_display_control(uint8_t flags){
+    lcd_static_write(LCD_DISPLAY_CONTROL | flags, 0);
+}
+
+static inline void lcd_static_mv_cursor(uint8_t row, uint8_t col){
+    // No write possible if target is outside of the LCD area
+    if (row >= LCD_STATIC_ROWS || col >= LCD_STATIC_COLS)
+        return;
+    lcd_static_write(LCD_SET_DDRAM_ADDR | (LCD_STATIC_LINE_ADDR(row) + col), 0);
+}
+
+static inline void lcd_static_putc(char c){
+    lcd_static_write((uint8_t) c, 1);
+}
+
+// Print at a position, wraps to the next rows and stops at the end of the display
+static inline void lcd_static_printf_at(const char *s, uint8_t row, uint8_t col){
+    lcd_static_mv_cursor(row, col);
+    for (; *s != '\0'; s++){
+        if (col >= LCD_STATIC_COLS){
+            if (++row >= LCD_STATIC_ROWS)
+                return;
+            col = 0;
+            lcd_static_mv_cursor(row, 0);
+        }
+        lcd_static_putc(*s);
+        col++;
+    }
+}
+
+static inline void lcd_static_create_custom(uint8_t addr, const uint8_t *character){
+#ifdef LCD_STATIC_FONT_5x10
+    const uint8_t max_row = 10;
+    if (addr >= 0x04)
+        return;
+    addr <<= 4;
+#else
+    const uint8_t max_row = 8;
+    if (addr >= 0x08)
+        return;
+    addr <<= 3;
+#endif
+
+    lcd_static_write(LCD_SET_CGRAM_ADDR | addr, 0);
+    for (uint8_t row = 0; row < max_row; row++)
+        lcd_static_write(character[row], 1);
+}
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* LCD_STATIC_H */
@@ -27,6 +27,7 @@
 #include "PCF8574.h"
 
 #define PCF8574_I2C_ADDR    0x27
+#define I2C_BUS_SPEED_HZ    100000      // SERCOM1 clock speed set in Harmony
 
 bool I2C_Write(uint16_t address, uint8_t* wrData, uint32_t wrLength){
     bool ret;
@@ -67,9 +68,10 @@ int main ( void )
     pcf8574_configure(&expander_config, PCF8574_I2C_ADDR, &I2C_Write, &I2C_Read);
         
     // Configure LCD interface
-    lcd_interface.config = &expander_config;
-    lcd_interface.write_fun = &pcf8574_lcd_if_write;
-    lcd_interface.read_fun = &pcf8574_lcd_if_read;
+    lcd_interface_init(&lcd_interface, &expander_config, &pcf8574_lcd_if_write, &pcf8574_lcd_if_read);
+    lcd_interface.write_burst_fun = &pcf8574_lcd_if_write_burst;
+    lcd_interface.burst_edge_us = pcf8574_lcd_if_burst_edge_us(I2C_BUS_SPEED_HZ);
+    lcd_interface.min_latency_us = pcf8574_lcd_if_latency_us(I2C_BUS_SPEED_HZ);
     
     // Initialize LCD with selected configuration
     lcd_init(&lcd_config, &lcd_interface);
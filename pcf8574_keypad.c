@@ -0,0 +1,133 @@
+#include <stdint.h>
+#include <stddef.h>
+#include "pcf8574_keypad.h"
+
+/* The keypad is read from either side: one side is driven low while the lines of the
+ * other side are released high and read. A single read in the current orientation
+ * detects any pressed key, the full matrix is only resolved while keys are pressed. */
+
+// Release the sensed lines, drive the other side low and read, returns the pulled down lines
+static bool keypad_sense(pcf8574_keypad_s *keypad, uint8_t sense_mask, uint8_t *active){
+    pcf8574_config_s *device = keypad->device;
+    
+    // Only switch the orientation if needed
+    if (device->wr_buffer != sense_mask && !pcf8574_write(device, sense_mask))
+        return false;
+    if (!pcf8574_read(device, sense_mask))
+        return false;
+    
+    *active = ~device->rd_buffer & sense_mask;
+    return true;
+}
+
+// Resolve pressed keys from active rows and columns, false if the scan is ambiguous
+static bool keypad_resolve(pcf8574_keypad_s *keypad, uint8_t rows, uint8_t cols, uint16_t *keys){
+    uint8_t col_rows[KEYPAD_COLS] = {0};
+    
+    // Keys of a single row or column are the product of both sides
+    if ((rows & (rows - 1)) == 0 || (cols & (cols - 1)) == 0){
+        for (uint8_t col = 0; col < KEYPAD_COLS; col++){
+            if (cols & (1 << col))
+                col_rows[col] = rows;
+        }
+    }
+    else{
+        // Several rows and columns: scan only the active columns one by one
+        for (uint8_t col = 0; col < KEYPAD_COLS; col++){
+            if (!(cols & (1 << col)))
+                continue;
+            if (!pcf8574_write(keypad->device, KEYPAD_ROW_MASK | (KEYPAD_COL_MASK & ~(1 << col))))
+                return false;
+            if (!pcf8574_read(keypad->device, KEYPAD_ROW_MASK))
+                return false;
+            col_rows[col] = (~keypad->device->rd_buffer & KEYPAD_ROW_MASK) >> 4;
+        }
+        
+        // Without diodes three keys of a rectangle show a ghost key at the fourth corner
+        for (uint8_t a = 0; a < KEYPAD_COLS; a++){
+            for (uint8_t b = a + 1; b < KEYPAD_COLS; b++){
+                uint8_t shared = col_rows[a] & col_rows[b];
+                if (shared & (shared - 1))
+                    return false;
+            }
+        }
+    }
+    
+    *keys = 0;
+    for (uint8_t col = 0; col < KEYPAD_COLS; col++){
+        for (uint8_t row = 0; row < KEYPAD_ROWS; row++){
+            if (col_rows[col] & (1 << row))
+                *keys |= KEYPAD_KEY(row, col);
+        }
+    }
+    return true;
+}
+
+bool pcf8574_keypad_init(pcf8574_keypad_s *keypad, pcf8574_config_s *device, uint8_t debounce_scans, bool use_irq, PCF8574_Key_Fcn key_fun, void *context){
+    keypad->device = device;
+    keypad->use_irq = use_irq;
+    keypad->irq_pending = false;
+    keypad->stable = 0;
+    keypad->last = 0;
+    keypad->count = 0;
+    keypad->debounce_scans = debounce_scans;
+    keypad->key_fun = key_fun;
+    keypad->context = context;
+    
+    // Columns low, rows released
+    return pcf8574_write(device, KEYPAD_ROW_MASK);
+}
+
+void pcf8574_keypad_irq(pcf8574_keypad_s *keypad){
+    keypad->irq_pending = true;
+}
+
+bool pcf8574_keypad_scan(pcf8574_keypad_s *keypad){
+    uint8_t first, active, other;
+    uint16_t keys = 0;
+    uint16_t changed;
+    
+    // Nothing pressed and nothing to debounce: the INT line signals the next press
+    if (keypad->use_irq && !keypad->irq_pending && keypad->stable == 0 && keypad->last == 0)
+        return true;
+    keypad->irq_pending = false;
+    
+    // Sense the side that is released already, a single read if no key is pressed
+    first = (keypad->device->wr_buffer == KEYPAD_COL_MASK) ? KEYPAD_COL_MASK : KEYPAD_ROW_MASK;
+    if (!keypad_sense(keypad, first, &active))
+        return false;
+    
+    if (active){
+        // Reverse the orientation to find the other side
+        if (!keypad_sense(keypad, first ^ 0xFF, &other))
+            return false;
+        if (first == KEYPAD_COL_MASK){
+            uint8_t swap = active;
+            active = other;
+            other = swap;
+        }
+        
+        // Ambiguous scans are dropped, key states stay unchanged
+        if (!keypad_resolve(keypad, active >> 4, other, &keys))
+            return true;
+    }
+    
+    // Debounce the whole matrix
+    if (keys != keypad->last){
+        keypad->last = keys;
+        keypad->count = 0;
+    }
+    if (keypad->count < keypad->debounce_scans){
+        keypad->count++;
+        return true;
+    }
+    
+    // Deliver key changes
+    changed = keypad->stable ^ keypad->last;
+    keypad->stable = keypad->last;
+    for (uint8_t key = 0; changed && key < KEYPAD_ROWS * KEYPAD_COLS; key++){
+        if (changed & (1 << key) && keypad->key_fun != NULL)
+            keypad->key_fun(keypad->context, key, (keypad->stable & (1 << key)) != 0);
+    }
+    return true;
+}
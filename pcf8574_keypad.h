@@ -0,0 +1,48 @@
+#ifndef PCF8574_KEYPAD_H
+#define	PCF8574_KEYPAD_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "PCF8574.h"
+    
+// Mapping of the 4x4 matrix to I/O Expander pins, columns P0..P3 and rows P4..P7
+#define KEYPAD_COL_MASK     0x0F
+#define KEYPAD_ROW_MASK     0xF0
+#define KEYPAD_ROWS         4
+#define KEYPAD_COLS         4
+    
+// Bit of a key in the key state, key number is row * KEYPAD_COLS + col
+#define KEYPAD_KEY(row, col)    ((uint16_t) 1 << ((row) * KEYPAD_COLS + (col)))
+    
+// Key event callback with key number and new state
+typedef void (*PCF8574_Key_Fcn)(void *context, uint8_t key, bool pressed);
+
+// Keypad state
+typedef struct{
+    pcf8574_config_s *device;       // Expander the keypad is connected to
+    bool use_irq;                   // Skip idle reads until the INT line fired
+    volatile bool irq_pending;      // Set by the INT handler
+    uint16_t stable;                // Debounced key states
+    uint16_t last;                  // Key states of the previous scan
+    uint8_t count;                  // Consecutive scans with equal key states
+    uint8_t debounce_scans;         // Scans a key state has to be held
+    PCF8574_Key_Fcn key_fun;        // Callback for debounced key changes
+    void *context;                  // Passed to the callback
+}pcf8574_keypad_s;
+
+// Drive all columns low so a key press pulls its row low
+bool pcf8574_keypad_init(pcf8574_keypad_s *keypad, pcf8574_config_s *device, uint8_t debounce_scans, bool use_irq, PCF8574_Key_Fcn key_fun, void *context);
+// Signal a falling edge of the INT line, safe to call from the interrupt handler (no bus access)
+void pcf8574_keypad_irq(pcf8574_keypad_s *keypad);
+// Scan the keypad and deliver debounced key changes, call at the scan rate
+bool pcf8574_keypad_scan(pcf8574_keypad_s *keypad);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* PCF8574_KEYPAD_H */
@@ -0,0 +1,83 @@
+#include <stdint.h>
+#include "pcf8574_port.h"
+
+// Byte of a device within a 64-bit pin space
+#define PORT_BYTE(value, device)    ((uint8_t) ((value) >> (8 * (device))))
+
+void pcf8574_port_init(pcf8574_port_s *port, pcf8574_config_s **devices, uint8_t count, uint64_t input_mask){
+    if (count > PCF8574_PORT_MAX_DEVICES)
+        count = PCF8574_PORT_MAX_DEVICES;
+    
+    port->count = count;
+    port->output = 0;
+    port->input = 0;
+    port->input_mask = input_mask;
+    
+    // Start from the state last written to each device
+    for (uint8_t i = 0; i < count; i++){
+        port->devices[i] = devices[i];
+        port->output |= (uint64_t) devices[i]->wr_buffer << (8 * i);
+    }
+}
+
+void pcf8574_port_set(pcf8574_port_s *port, uint64_t pins){
+    port->output |= pins;
+}
+
+void pcf8574_port_clear(pcf8574_port_s *port, uint64_t pins){
+    port->output &= ~pins;
+}
+
+void pcf8574_port_toggle(pcf8574_port_s *port, uint64_t pins){
+    port->output ^= pins;
+}
+
+void pcf8574_port_write(pcf8574_port_s *port, uint64_t pins, uint64_t levels){
+    port->output = (port->output & ~pins) | (levels & pins);
+}
+
+bool pcf8574_port_read(const pcf8574_port_s *port, uint8_t pin){
+    // Pin has to belong to one of the devices, this also keeps the shift below 64
+    if (pin >= 8 * port->count)
+        return false;
+    return (port->input & PCF8574_PIN(pin)) != 0;
+}
+
+bool pcf8574_port_commit(pcf8574_port_s *port){
+    bool ret = true;
+    
+    for (uint8_t i = 0; i < port->count; i++){
+        // Open-collector pins have to stay high to be read
+        uint8_t data = PORT_BYTE(port->output | port->input_mask, i);
+        
+        // Skip devices already showing the output
+        if (data == port->devices[i]->wr_buffer)
+            continue;
+        
+        // A failed write keeps the previous output in the buffer, so the next commit repeats it
+        if (!pcf8574_write(port->devices[i], data))
+            ret = false;
+    }
+    return ret;
+}
+
+bool pcf8574_port_sample(pcf8574_port_s *port){
+    bool ret = true;
+    
+    for (uint8_t i = 0; i < port->count; i++){
+        uint8_t mask = PORT_BYTE(port->input_mask, i);
+        
+        // Devices without inputs are not read
+        if (mask == 0x00)
+            continue;
+        
+        // Pins are asserted by the last commit, so this is a single read
+        if (!pcf8574_read(port->devices[i], mask)){
+            ret = false;
+            continue;
+        }
+        port->input = (port->input & ~((uint64_t) 0xFF << (8 * i))) |
+                      ((uint64_t) (port->devices[i]->rd_buffer & mask) << (8 * i));
+    }
+    return ret;
+}
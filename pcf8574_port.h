@@ -0,0 +1,48 @@
+#ifndef PCF8574_PORT_H
+#define	PCF8574_PORT_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "PCF8574.h"
+    
+#define PCF8574_PORT_MAX_DEVICES    8
+    
+// Bit of a virtual pin, pin n is pin n%8 of device n/8
+#define PCF8574_PIN(n)              ((uint64_t) 1 << (n))
+
+// Virtual GPIO port aggregating several expanders
+typedef struct{
+    pcf8574_config_s *devices[PCF8574_PORT_MAX_DEVICES];    // Expander of pins 8*i..8*i+7
+    uint8_t count;          // Number of devices
+    uint64_t output;        // Shadow output register
+    uint64_t input_mask;    // Pins used as inputs, always driven high
+    uint64_t input;         // Levels of the last sample
+}pcf8574_port_s;
+
+// Take over the devices, shadow register starts with their last written output
+void pcf8574_port_init(pcf8574_port_s *port, pcf8574_config_s **devices, uint8_t count, uint64_t input_mask);
+
+/* Shadow register, no bus access */
+void pcf8574_port_set(pcf8574_port_s *port, uint64_t pins);
+void pcf8574_port_clear(pcf8574_port_s *port, uint64_t pins);
+void pcf8574_port_toggle(pcf8574_port_s *port, uint64_t pins);
+// Set the masked pins to the given levels
+void pcf8574_port_write(pcf8574_port_s *port, uint64_t pins, uint64_t levels);
+// Level of a pin from the last sample, false for pins beyond the devices of the port
+bool pcf8574_port_read(const pcf8574_port_s *port, uint8_t pin);
+
+/* Bus access */
+// Write every device whose output changed, one transaction each
+bool pcf8574_port_commit(pcf8574_port_s *port);
+// Read every device with input pins, one transaction each
+bool pcf8574_port_sample(pcf8574_port_s *port);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* PCF8574_PORT_H */